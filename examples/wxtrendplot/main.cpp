@@ -157,8 +157,8 @@ wxMainForm::wxMainForm(const wxString& title,
    srand(1000);
    m_ticks = 0;
 
-    int handle = m_trend_plot->AddDataSet(wxT("one"), *wxBLUE);
-    handle = m_trend_plot->AddDataSet(wxT("two"), *wxGREEN);
+    m_trend_plot->AddDataSet(wxT("one"), *wxBLUE);
+    m_trend_plot->AddDataSet(wxT("two"), *wxGREEN);
     m_trend_plot->ShowLegend(true);
     m_trend_plot->UpdatePlot();
    
@@ -171,9 +171,16 @@ wxMainForm::~wxMainForm(void)
 
 void wxMainForm::OnTimer(wxTimerEvent& event)
 {
-    for(size_t count = 0; count < m_trend_plot->GetPlotCount(); count++)
+    std::vector<double> row(m_trend_plot->GetPlotCount());
+    
+    for(size_t count = 0; count < row.size(); count++)
+    {
+        row[count] = rand()/(RAND_MAX * 0.25);
+    }
+    
+    if(!row.empty())
     {
-        m_trend_plot->AddPoint(count, m_ticks * 0.5, rand()/(RAND_MAX * 0.25));
+        m_trend_plot->AddRow(m_ticks * 0.5, &row[0], row.size());
     }
 
     m_trend_plot->UpdatePlot();
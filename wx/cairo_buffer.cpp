@@ -0,0 +1,424 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: cairo_buffer.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the off-screen buffer used by
+//|    the widgets when rendering with RENDER_CAIRO_BUFFER.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+#include "wx/cairo_buffer.h"
+#include "wx/pixel_convert.h"
+
+#include <wx/rawbmp.h>
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    CanDrawDirect()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This function checks whether cairo can draw straight into the pixels
+//|    of a 32 bit bitmap. The bytes of each pixel have to be in the same
+//|    order as a CAIRO_FORMAT_ARGB32 surface and the pixels have to stay
+//|    where they are once raw access to them has finished, which is only
+//|    the case for the DIB sections used by wxMSW.
+//|
+//| RETURNS:
+//|    true if cairo can draw into the bitmap.
+//|
+//+------------------------------------------------------------------------------
+static bool CanDrawDirect(void)
+{
+#if defined(__WXMSW__)
+    return wxAlphaPixelFormat::SizePixel == 4 &&
+           wxAlphaPixelFormat::BLUE == 0 &&
+           wxAlphaPixelFormat::GREEN == 1 &&
+           wxAlphaPixelFormat::RED == 2 &&
+           wxAlphaPixelFormat::ALPHA == 3;
+#else
+    return false;
+#endif
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxCairoBuffer()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the buffer class. Nothing is allocated
+//|    until the size of the buffer is set.
+//|
+//+------------------------------------------------------------------------------
+wxCairoBuffer::wxCairoBuffer(void)
+{
+    m_width = 0;
+    m_height = 0;
+    m_image_data = NULL;
+    m_image_data_length = 0;
+    m_cairo_surface = NULL;
+    m_cairo_image = NULL;
+    m_direct = false;
+    m_flipped = false;
+}
+
+
+wxCairoBuffer::~wxCairoBuffer(void)
+{
+    Destroy();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Destroy()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method releases the buffer, surface and bitmap.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxCairoBuffer::Destroy(void)
+{
+    DestroySurface();
+
+    free(m_image_data);
+    m_image_data = NULL;
+    m_image_data_length = 0;
+
+    m_bitmap = wxBitmap();
+
+    m_width = 0;
+    m_height = 0;
+    m_direct = false;
+    m_flipped = false;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DestroySurface()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method releases the cairo surface and context.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxCairoBuffer::DestroySurface(void)
+{
+    if(m_cairo_image != NULL)
+    {
+        cairo_destroy(m_cairo_image);
+        m_cairo_image = NULL;
+    }
+
+    if(m_cairo_surface != NULL)
+    {
+        cairo_surface_destroy(m_cairo_surface);
+        m_cairo_surface = NULL;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AttachToBitmap()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method wraps the pixels of the bitmap in a cairo surface. The
+//|    surface is kept as long as the pixels don't move. Bottom-up bitmaps
+//|    are wrapped from their last row and drawn into upside down.
+//|
+//| RETURNS:
+//|    false if the pixels of the bitmap can't be accessed.
+//|
+//+------------------------------------------------------------------------------
+bool wxCairoBuffer::AttachToBitmap(void)
+{
+    wxAlphaPixelData data(m_bitmap);
+
+    if(!data)
+    {
+        return false;
+    }
+
+    wxAlphaPixelData::Iterator pixel(data);
+    unsigned char* pixels = (unsigned char*)pixel.m_ptr;
+    int stride = data.GetRowStride();
+
+    m_flipped = (stride < 0);
+
+    if(m_flipped)
+    {
+        pixels += (m_height - 1) * stride;
+        stride = -stride;
+    }
+
+    if(m_cairo_surface != NULL &&
+       cairo_image_surface_get_data(m_cairo_surface) == pixels)
+    {
+        return true;
+    }
+
+    DestroySurface();
+
+    m_cairo_surface = cairo_image_surface_create_for_data(
+                                    pixels,
+                                    CAIRO_FORMAT_ARGB32,
+                                    m_width,
+                                    m_height,
+                                    stride);
+    m_cairo_image = cairo_create(m_cairo_surface);
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Resize()
+//|
+//| PARAMETERS:
+//|    width  (I) - The width of the widget.
+//|    height (I) - The height of the widget.
+//|
+//| FUNCTION:
+//|    This method is called from the size and paint events to make sure
+//|    the buffer matches the size of the widget.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxCairoBuffer::Resize(int width, int height)
+{
+    if(width == m_width && height == m_height)
+    {
+        return;
+    }
+
+    Destroy();
+
+    if(width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    m_width = width;
+    m_height = height;
+
+    // Let cairo draw straight into the bitmap if we can, otherwise
+    // it draws into a buffer that is copied into the bitmap.
+    if(CanDrawDirect())
+    {
+        m_bitmap = wxBitmap(width, height, 32);
+
+        if(AttachToBitmap())
+        {
+            m_direct = true;
+            return;
+        }
+    }
+
+    m_image_data_length = width * height * 4;
+    m_image_data = (unsigned char*)malloc(m_image_data_length);
+
+    m_cairo_surface = cairo_image_surface_create_for_data(
+                                    m_image_data,
+                                    CAIRO_FORMAT_RGB24,
+                                    width,
+                                    height,
+                                    width * 4);
+    m_cairo_image = cairo_create(m_cairo_surface);
+
+    m_bitmap = wxBitmap(width, height, 24);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Begin()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called before drawing a frame. The state of the
+//|    context is saved so that anything changed while drawing doesn't
+//|    leak into the next frame.
+//|
+//| RETURNS:
+//|    The cairo context or NULL if the buffer has no size.
+//|
+//+------------------------------------------------------------------------------
+cairo_t* wxCairoBuffer::Begin(void)
+{
+    if(m_direct && !AttachToBitmap())
+    {
+        return NULL;
+    }
+
+    if(m_cairo_image == NULL)
+    {
+        return NULL;
+    }
+
+    cairo_save(m_cairo_image);
+
+    if(m_direct)
+    {
+        if(m_flipped)
+        {
+            cairo_translate(m_cairo_image, 0, m_height);
+            cairo_scale(m_cairo_image, 1, -1);
+        }
+
+        // Start from an opaque background so that the alpha
+        // channel of the bitmap is valid when it is drawn.
+        cairo_set_operator(m_cairo_image, CAIRO_OPERATOR_SOURCE);
+        cairo_set_source_rgb(m_cairo_image, 1, 1, 1);
+        cairo_paint(m_cairo_image);
+        cairo_set_operator(m_cairo_image, CAIRO_OPERATOR_OVER);
+    }
+
+    return m_cairo_image;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    End()
+//|
+//| PARAMETERS:
+//|    dc (I) - The device context to draw the frame on.
+//|
+//| FUNCTION:
+//|    This method is called once a frame has been drawn. Unless cairo drew
+//|    straight into the bitmap the frame is translated from the format
+//|    stored by cairo into the bitmap. The bitmap is then drawn on the
+//|    device context.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxCairoBuffer::End(wxDC& dc)
+{
+    if(m_cairo_image == NULL)
+    {
+        return;
+    }
+
+    cairo_restore(m_cairo_image);
+    cairo_surface_flush(m_cairo_surface);
+
+    // The frame is already in the bitmap
+    if(m_direct)
+    {
+        dc.DrawBitmap(m_bitmap, 0, 0, false);
+        return;
+    }
+
+    {
+        wxNativePixelData data(m_bitmap);
+
+        if(!data)
+        {
+            return;
+        }
+
+        wxNativePixelData::Iterator row(data);
+
+        // If the bitmap stores packed 24 bit pixels then each row
+        // can be converted in one go, otherwise fall back to
+        // converting a pixel at a time.
+        bool packed = (wxNativePixelFormat::SizePixel == 3);
+        int order = PIXEL_ORDER_RGB;
+
+        if(wxNativePixelFormat::BLUE == 0)
+        {
+            order = PIXEL_ORDER_BGR;
+        }
+
+        for(int y = 0; y < m_height; y++)
+        {
+            const unsigned char* input = m_image_data + (y * m_width * 4);
+
+            if(packed)
+            {
+                wxCairoConvertPixels(input,
+                                     (unsigned char*)row.m_ptr,
+                                     m_width,
+                                     order);
+            }
+            else
+            {
+                wxNativePixelData::Iterator pixel = row;
+
+                for(int x = 0; x < m_width; x++)
+                {
+                    pixel.Red()   = input[2];
+                    pixel.Green() = input[1];
+                    pixel.Blue()  = input[0];
+
+                    ++pixel;
+                    input += 4;
+                }
+            }
+
+            row.OffsetY(data, 1);
+        }
+    }
+
+    dc.DrawBitmap(m_bitmap, 0, 0, false);
+}
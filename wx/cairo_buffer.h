@@ -0,0 +1,88 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: cairo_buffer.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the off-screen buffer used by
+//|    the widgets when rendering with RENDER_CAIRO_BUFFER.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __CAIRO_BUFFER_H__
+#define __CAIRO_BUFFER_H__
+
+#include <cairo.h>
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+ 
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxCairoBuffer
+//|
+//| DESCRIPTION:
+//|    This class owns the memory buffer, cairo surface and bitmap used
+//|    to render a widget off-screen with cairo and copy it onto the
+//|    screen. They are only re-allocated when the size of the widget
+//|    changes so that painting doesn't allocate any memory. Where the
+//|    platform allows it cairo draws straight into the bitmap so that
+//|    no copying is needed at all.
+//|
+//+------------------------------------------------------------------------------
+class wxCairoBuffer
+{
+    public:
+        wxCairoBuffer(void);
+
+        ~wxCairoBuffer(void);
+
+        // Set the size of the buffer. Nothing is re-allocated
+        // unless the size has changed.
+        void Resize(int width, int height);
+
+        // Get the cairo context to draw the next frame with
+        cairo_t* Begin(void);
+
+        // Copy the frame that was drawn onto the device context
+        void End(wxDC& dc);
+
+    private:
+        void Destroy(void);
+        void DestroySurface(void);
+        bool AttachToBitmap(void);
+
+        int m_width;
+        int m_height;
+
+        // The buffer cairo renders into
+        unsigned char* m_image_data;
+        unsigned int   m_image_data_length;
+
+        cairo_surface_t* m_cairo_surface;
+        cairo_t*         m_cairo_image;
+
+        // The bitmap the frame is copied into for drawing on screen
+        wxBitmap m_bitmap;
+
+        // Set when cairo draws straight into the pixels of the bitmap
+        // rather than into m_image_data. If the bitmap is stored
+        // bottom-up the drawing is flipped to match.
+        bool m_direct;
+        bool m_flipped;
+};
+
+#endif // __CAIRO_BUFFER_H__
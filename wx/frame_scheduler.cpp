@@ -0,0 +1,228 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: frame_scheduler.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of a class used to limit how
+//|    often a widget is repainted.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include "wx/frame_scheduler.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxFrameScheduler()
+//|
+//| PARAMETERS:
+//|    window  (I) - The widget to repaint.
+//|    max_fps (I) - The maximum number of frames per second.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the frame scheduler class.
+//|
+//+------------------------------------------------------------------------------
+wxFrameScheduler::wxFrameScheduler(wxWindow* window,
+                                   int       max_fps)
+{
+    m_window = window;
+    m_dirty = false;
+
+    SetMaxFPS(max_fps);
+    ResetCounters();
+
+    m_clock.Start(m_interval);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetMaxFPS()
+//|
+//| PARAMETERS:
+//|    max_fps (I) - The maximum number of frames per second or 0 for
+//|                  no limit.
+//|
+//| FUNCTION:
+//|    This method is called to set how often the widget can be repainted.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxFrameScheduler::SetMaxFPS(int max_fps)
+{
+    if(max_fps < 0)
+    {
+        max_fps = 0;
+    }
+
+    m_max_fps = max_fps;
+    m_interval = 0;
+
+    if(m_max_fps != 0)
+    {
+        m_interval = 1000 / m_max_fps;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    RequestFrame()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called when the contents of the widget have changed.
+//|    If a frame is already being held back the request is merged into
+//|    it. Otherwise the widget is refreshed straight away if the frame
+//|    interval has passed or when it does if it hasn't.
+//|
+//|    Nothing waits for the refresh to be painted, since a hidden or
+//|    minimised widget may never be painted. Refreshing it again before
+//|    the paint arrives is cheap as the window system merges them.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxFrameScheduler::RequestFrame(void)
+{
+    m_frames_requested++;
+
+    if(m_dirty)
+    {
+        return;
+    }
+
+    long elapsed = m_clock.Time();
+
+    if(elapsed >= m_interval)
+    {
+        m_window->Refresh(false);
+    }
+    else
+    {
+        m_dirty = true;
+        Start(m_interval - elapsed, wxTIMER_ONE_SHOT);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Notify()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called by the timer once the frame interval has
+//|    passed to refresh the widget.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxFrameScheduler::Notify(void)
+{
+    if(m_dirty)
+    {
+        m_dirty = false;
+        m_window->Refresh(false);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FrameRendered()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called from the paint handler of the widget. The
+//|    frame interval starts again from here.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxFrameScheduler::FrameRendered(void)
+{
+    m_frames_rendered++;
+    m_dirty = false;
+
+    if(IsRunning())
+    {
+        Stop();
+    }
+
+    m_clock.Start();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ResetCounters()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method resets the counts of frames requested and rendered.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxFrameScheduler::ResetCounters(void)
+{
+    m_frames_requested = 0;
+    m_frames_rendered = 0;
+}
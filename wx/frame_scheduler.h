@@ -0,0 +1,102 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: frame_scheduler.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of a class used to limit how often
+//|    a widget is repainted.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __FRAME_SCHEDULER_H__
+#define __FRAME_SCHEDULER_H__
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <wx/timer.h>
+#include <wx/stopwatch.h>
+
+// The default maximum number of frames painted per second
+#define FRAME_SCHEDULER_DEFAULT_FPS 30
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxFrameScheduler
+//|
+//| DESCRIPTION:
+//|    This class coalesces requests to repaint a widget so that it is
+//|    painted at most once per frame interval. A request made within
+//|    the interval of the last frame is held back by a one shot timer
+//|    and any further requests made before the timer fires are merged
+//|    into it.
+//|
+//+------------------------------------------------------------------------------
+class wxFrameScheduler : public wxTimer
+{
+    public:
+        wxFrameScheduler(wxWindow* window,
+                         int       max_fps = FRAME_SCHEDULER_DEFAULT_FPS);
+
+        // Set the maximum number of frames per second. A value of
+        // 0 repaints as soon as possible.
+        void SetMaxFPS(int max_fps);
+
+        int GetMaxFPS(void) const
+        {
+            return m_max_fps;
+        }
+
+        // Ask for the widget to be repainted
+        void RequestFrame(void);
+
+        // Called by the paint handler of the widget
+        void FrameRendered(void);
+
+        // The number of calls to RequestFrame() and the number of
+        // frames actually painted.
+        unsigned long GetFramesRequested(void) const
+        {
+            return m_frames_requested;
+        }
+
+        unsigned long GetFramesRendered(void) const
+        {
+            return m_frames_rendered;
+        }
+
+        void ResetCounters(void);
+
+        virtual void Notify(void);
+
+    private:
+        wxWindow* m_window;
+
+        int  m_max_fps;
+        long m_interval;
+
+        // Set while the timer is holding back a frame
+        bool m_dirty;
+
+        // Measures the time since the last frame was painted
+        wxStopWatch m_clock;
+
+        unsigned long m_frames_requested;
+        unsigned long m_frames_rendered;
+};
+
+#endif // __FRAME_SCHEDULER_H__
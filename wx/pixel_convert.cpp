@@ -0,0 +1,308 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: pixel_convert.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the routine used to convert
+//|    pixels rendered by cairo into the format used by wxWidgets.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+#include "wx/pixel_convert.h"
+
+// The SIMD versions are only built for x86 compilers that let us
+// enable the instruction sets per function so that the rest of the
+// library still runs on older CPUs.
+#if (defined(__i386__) || defined(__x86_64__)) && \
+    defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#    define PIXEL_CONVERT_SIMD
+#    define PIXEL_CONVERT_TARGET(isa) __attribute__((target(isa)))
+#    include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)) && _MSC_VER >= 1700
+#    define PIXEL_CONVERT_SIMD
+#    define PIXEL_CONVERT_TARGET(isa)
+#    include <intrin.h>
+#    include <immintrin.h>
+#endif
+
+typedef void (*ConvertFunction)(const unsigned char* input,
+                                unsigned char*       output,
+                                size_t               pixels,
+                                int                  order);
+
+// Cairo stores RGB24 pixels as native endian 32 bit words so on
+// little endian machines the bytes are in blue, green, red order.
+// These give the input byte used for each output byte.
+static const int g_rgb_offsets[3] = { 2, 1, 0 };
+static const int g_bgr_offsets[3] = { 0, 1, 2 };
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ConvertScalar()
+//|
+//| PARAMETERS:
+//|    input  (I) - The pixels rendered by cairo.
+//|    output (O) - The packed 24 bit pixels.
+//|    pixels (I) - The number of pixels to convert.
+//|    order  (I) - PIXEL_ORDER_RGB or PIXEL_ORDER_BGR.
+//|
+//| FUNCTION:
+//|    This is the plain C++ version of the conversion used when the CPU
+//|    doesn't support anything faster and for the pixels left over at
+//|    the end of a run by the SIMD versions.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+static void ConvertScalar(const unsigned char* input,
+                          unsigned char*       output,
+                          size_t               pixels,
+                          int                  order)
+{
+    const int* offsets = (order == PIXEL_ORDER_BGR) ? g_bgr_offsets : g_rgb_offsets;
+
+    for(size_t count = 0; count < pixels; count++)
+    {
+        output[0] = input[offsets[0]];
+        output[1] = input[offsets[1]];
+        output[2] = input[offsets[2]];
+
+        input += 4;
+        output += 3;
+    }
+}
+
+
+#ifdef PIXEL_CONVERT_SIMD
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ConvertSSSE3()
+//|
+//| PARAMETERS:
+//|    input  (I) - The pixels rendered by cairo.
+//|    output (O) - The packed 24 bit pixels.
+//|    pixels (I) - The number of pixels to convert.
+//|    order  (I) - PIXEL_ORDER_RGB or PIXEL_ORDER_BGR.
+//|
+//| FUNCTION:
+//|    This converts 16 pixels at a time. Each group of 4 pixels is packed
+//|    into the low 12 bytes of a register with a byte shuffle and the
+//|    four groups are then stitched into three 16 byte stores.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+PIXEL_CONVERT_TARGET("ssse3")
+static void ConvertSSSE3(const unsigned char* input,
+                         unsigned char*       output,
+                         size_t               pixels,
+                         int                  order)
+{
+    const int* offsets = (order == PIXEL_ORDER_BGR) ? g_bgr_offsets : g_rgb_offsets;
+    const __m128i mask = _mm_setr_epi8(offsets[0],      offsets[1],      offsets[2],
+                                       offsets[0] + 4,  offsets[1] + 4,  offsets[2] + 4,
+                                       offsets[0] + 8,  offsets[1] + 8,  offsets[2] + 8,
+                                       offsets[0] + 12, offsets[1] + 12, offsets[2] + 12,
+                                       -1, -1, -1, -1);
+    size_t count = 0;
+
+    for(; count + 16 <= pixels; count += 16)
+    {
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(input +  0)), mask);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(input + 16)), mask);
+        __m128i c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(input + 32)), mask);
+        __m128i d = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(input + 48)), mask);
+
+        _mm_storeu_si128((__m128i*)(output +  0), _mm_or_si128(a, _mm_slli_si128(b, 12)));
+        _mm_storeu_si128((__m128i*)(output + 16), _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+        _mm_storeu_si128((__m128i*)(output + 32), _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+
+        input += 64;
+        output += 48;
+    }
+
+    ConvertScalar(input, output, pixels - count, order);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ConvertAVX2()
+//|
+//| PARAMETERS:
+//|    input  (I) - The pixels rendered by cairo.
+//|    output (O) - The packed 24 bit pixels.
+//|    pixels (I) - The number of pixels to convert.
+//|    order  (I) - PIXEL_ORDER_RGB or PIXEL_ORDER_BGR.
+//|
+//| FUNCTION:
+//|    This converts 8 pixels at a time. The byte shuffle packs each half
+//|    of the register separately so the two 12 byte halves are then
+//|    moved next to each other with a cross lane permute.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+PIXEL_CONVERT_TARGET("avx2")
+static void ConvertAVX2(const unsigned char* input,
+                        unsigned char*       output,
+                        size_t               pixels,
+                        int                  order)
+{
+    const int* offsets = (order == PIXEL_ORDER_BGR) ? g_bgr_offsets : g_rgb_offsets;
+    const __m256i mask = _mm256_setr_epi8(offsets[0],      offsets[1],      offsets[2],
+                                          offsets[0] + 4,  offsets[1] + 4,  offsets[2] + 4,
+                                          offsets[0] + 8,  offsets[1] + 8,  offsets[2] + 8,
+                                          offsets[0] + 12, offsets[1] + 12, offsets[2] + 12,
+                                          -1, -1, -1, -1,
+                                          offsets[0],      offsets[1],      offsets[2],
+                                          offsets[0] + 4,  offsets[1] + 4,  offsets[2] + 4,
+                                          offsets[0] + 8,  offsets[1] + 8,  offsets[2] + 8,
+                                          offsets[0] + 12, offsets[1] + 12, offsets[2] + 12,
+                                          -1, -1, -1, -1);
+    const __m256i pack = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    size_t count = 0;
+
+    for(; count + 8 <= pixels; count += 8)
+    {
+        __m256i data = _mm256_loadu_si256((const __m256i*)input);
+
+        data = _mm256_shuffle_epi8(data, mask);
+        data = _mm256_permutevar8x32_epi32(data, pack);
+
+        _mm_storeu_si128((__m128i*)output, _mm256_castsi256_si128(data));
+        _mm_storel_epi64((__m128i*)(output + 16), _mm256_extracti128_si256(data, 1));
+
+        input += 32;
+        output += 24;
+    }
+
+    ConvertScalar(input, output, pixels - count, order);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SelectConvertFunction()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method checks which instruction sets the CPU supports.
+//|
+//| RETURNS:
+//|    The fastest conversion routine the CPU can run.
+//|
+//+------------------------------------------------------------------------------
+static ConvertFunction SelectConvertFunction(void)
+{
+    bool ssse3 = false;
+    bool avx2 = false;
+
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    ssse3 = __builtin_cpu_supports("ssse3");
+    avx2 = __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    ssse3 = (info[2] & (1 << 9)) != 0;
+
+    // AVX2 also needs the OS to save the upper halves of the
+    // registers on a context switch.
+    bool os_avx = (info[2] & (1 << 27)) != 0 &&
+                  (info[2] & (1 << 28)) != 0 &&
+                  (_xgetbv(0) & 0x6) == 0x6;
+
+    if(os_avx && max_leaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#endif
+
+    if(avx2)
+    {
+        return ConvertAVX2;
+    }
+
+    if(ssse3)
+    {
+        return ConvertSSSE3;
+    }
+
+    return ConvertScalar;
+}
+
+#endif // PIXEL_CONVERT_SIMD
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxCairoConvertPixels()
+//|
+//| PARAMETERS:
+//|    input  (I) - The pixels rendered by cairo.
+//|    output (O) - The packed 24 bit pixels.
+//|    pixels (I) - The number of pixels to convert.
+//|    order  (I) - PIXEL_ORDER_RGB or PIXEL_ORDER_BGR.
+//|
+//| FUNCTION:
+//|    This method converts pixels from the format rendered by cairo to
+//|    packed 24 bit pixels using the fastest routine the CPU supports.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxCairoConvertPixels(const unsigned char* input,
+                          unsigned char*       output,
+                          size_t               pixels,
+                          int                  order)
+{
+#ifdef PIXEL_CONVERT_SIMD
+    // Only the GUI thread paints so there's no need to
+    // protect the first call.
+    static ConvertFunction convert = SelectConvertFunction();
+#else
+    static ConvertFunction convert = ConvertScalar;
+#endif
+
+    convert(input, output, pixels, order);
+}
@@ -0,0 +1,40 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: pixel_convert.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the routine used to convert
+//|    pixels rendered by cairo into the format used by wxWidgets.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __PIXEL_CONVERT_H__
+#define __PIXEL_CONVERT_H__
+
+#include <stddef.h>
+
+// The order of the channels written by wxCairoConvertPixels()
+#define PIXEL_ORDER_RGB 0
+#define PIXEL_ORDER_BGR 1
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxCairoConvertPixels()
+//|
+//| DESCRIPTION:
+//|    Convert a run of 32 bit pixels as stored by a CAIRO_FORMAT_RGB24
+//|    surface into packed 24 bit pixels in the order specified. The
+//|    fastest implementation supported by the CPU (AVX2, SSSE3 or plain
+//|    C++) is picked the first time this is called.
+//|
+//+------------------------------------------------------------------------------
+void wxCairoConvertPixels(const unsigned char* input,
+                          unsigned char*       output,
+                          size_t               pixels,
+                          int                  order);
+
+#endif // __PIXEL_CONVERT_H__
@@ -56,6 +56,8 @@
 #include <wx/artprov.h>
 
 #include "wx/wxcairo.h"
+#include "wx/cairo_buffer.h"
+#include "wx/frame_scheduler.h"
 
 
 //+------------------------------------------------------------------------------
@@ -98,17 +100,16 @@ class wxSpeedometer: public wxPanel
                   int      width,
                   int      height);
         
+        // Ask for the speedometer to be repainted. Requests are
+        // coalesced so that it is painted at most once per frame.
         void UpdateSpeedometer(void)
         {
-            wxRect rect = GetRect();
+            m_scheduler.RequestFrame();
+        }
         
-            // If the graph is currently not exposed then don't
-            // draw it un-necessarily. Otherwise we waste processor
-            // cycles for nothing.
-            //if(IsExposed(rect.x, rect.y))//, rect.width, rect.height))
-            {
-                Refresh(false);
-            }
+        wxFrameScheduler& GetFrameScheduler(void)
+        {
+            return m_scheduler;
         }
 
     private:
@@ -118,6 +119,12 @@ class wxSpeedometer: public wxPanel
         void OnSize(wxSizeEvent& event)
         {
             wxRect rect = GetClientRect();
+            
+            if(m_renderer == RENDER_CAIRO_BUFFER)
+            {
+                m_buffer.Resize(rect.width, rect.height);
+            }
+            
             //if(IsExposed(rect.x, rect.y, rect.width, rect.height))
             {
                 Refresh(false);
@@ -134,6 +141,12 @@ class wxSpeedometer: public wxPanel
         int m_menu_native_render;
         int m_menu_cairo_render_buffer;
         int m_menu_cairo_render_native;
+        
+        // The off-screen buffer used by RENDER_CAIRO_BUFFER
+        wxCairoBuffer m_buffer;
+        
+        // Limits how often the speedometer is repainted
+        wxFrameScheduler m_scheduler;
 };
 
 #endif // __WXSPEEDOMETER_H__
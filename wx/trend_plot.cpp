@@ -67,9 +67,67 @@
 
 #include <cairo.h>
 #include <ctime>
+#include <algorithm>
 using namespace std;
 
 
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DecimateSamples()
+//|
+//| PARAMETERS:
+//|    decimator   (I) - The decimator to add the points to.
+//|    group       (I) - The frame group the samples belong to.
+//|    samples     (I) - The samples stored in a column of the group.
+//|    scale       (I) - The scale of the encoding of the column.
+//|    offset      (I) - The offset of the encoding of the column less
+//|                      the y value at the bottom of the plot.
+//|    first       (I) - The index of the first frame to add.
+//|    last        (I) - One past the index of the last frame to add.
+//|    screen_x    (I) - The screen x co-ordinate of each frame from first.
+//|    min_y       (I) - The bottom of the plot in pixels.
+//|    y_increment (I) - The y units per pixel.
+//|
+//| FUNCTION:
+//|    This function adds the raw samples of a column to the decimator.
+//|    It is instantiated for each sample type so the encoding is only
+//|    looked at once per data set rather than once per point. Samples
+//|    that mark a gap in the data break the line.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+template <class T>
+static void DecimateSamples(wxTrendPlotDecimator&        decimator,
+                            const wxTrendPlotFrameGroup& group,
+                            const T*                     samples,
+                            double                       scale,
+                            double                       offset,
+                            size_t                       first,
+                            size_t                       last,
+                            const vector<int>&           screen_x,
+                            int                          min_y,
+                            double                       y_increment)
+{
+    for(size_t point = first; point < last; point++)
+    {
+        T sample = samples[group.Slot(point)];
+        
+        if(wxTrendPlotColumn::IsGap(sample))
+        {
+            decimator.AddGap();
+            continue;
+        }
+        
+        double y = (sample * scale) + offset;
+        
+        decimator.AddPoint(screen_x[point - first], min_y - (y / y_increment));
+    }
+}
+
+
 //+------------------------------------------------------------------------------
 //|
 //| NAME:
@@ -85,14 +143,30 @@ using namespace std;
 wxTrendPlot::wxTrendPlot(wxWindow* parent,
                          wxFrame*  status_bar_owner)
         : wxScrolledWindow(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize,
-                           wxHSCROLL | wxVSCROLL | wxNO_FULL_REPAINT_ON_RESIZE)
+                           wxHSCROLL | wxVSCROLL | wxNO_FULL_REPAINT_ON_RESIZE),
+          m_scheduler(this)
 {
     m_owner = parent;
     m_statusbar_owner = status_bar_owner;
 
     m_std_icon = wxArtProvider::GetIcon(wxART_INFORMATION);
-    m_clip = false;
+    m_clip = true;
+    m_strip_chart = false;
+    m_render_thread = NULL;
     SetBackgroundColour(*wxWHITE);
+    
+    m_chrome = NULL;
+    m_chrome_valid = false;
+    m_chrome_width = 0;
+    m_chrome_height = 0;
+    m_bottom_pad = 0;
+    m_top_pad = 0;
+    m_left_pad = 0;
+    m_right_pad = 0;
+    m_screen_group = NULL;
+    m_eviction_callback = NULL;
+    m_eviction_context = NULL;
+    m_decode_clock = 0;
    
     // Connect the event handlers for the widget 
     Connect(this->GetId(),
@@ -111,6 +185,10 @@ wxTrendPlot::wxTrendPlot(wxWindow* parent,
             wxEVT_PAINT,
             wxPaintEventHandler(wxTrendPlot::OnPaint));
 
+    Connect(wxID_ANY,
+            wxEVT_IDLE,
+            wxIdleEventHandler(wxTrendPlot::OnIdle));
+
     Connect(this->GetId(),
             wxEVT_CONTEXT_MENU,
             wxContextMenuEventHandler(wxTrendPlot::OnContextMenu));
@@ -131,6 +209,8 @@ wxTrendPlot::wxTrendPlot(wxWindow* parent,
     m_menu_cairo_render_buffer = item->GetId();
     item = m_popup_menu->AppendRadioItem(wxID_ANY, wxT("Cairo Native"));
     m_menu_cairo_render_native = item->GetId();
+    item = m_popup_menu->AppendRadioItem(wxID_ANY, wxT("Cairo Thread"));
+    m_menu_cairo_render_thread = item->GetId();
     
     m_popup_menu->Check(m_menu_cairo_render_native, true);
     SetRenderer(RENDER_CAIRO_NATIVE);
@@ -141,6 +221,10 @@ wxTrendPlot::wxTrendPlot(wxWindow* parent,
     m_menu_zoomout = item->GetId();
     item = m_popup_menu->AppendCheckItem(wxID_ANY, wxT("Pause"));
     m_menu_pause = item->GetId();
+    item = m_popup_menu->AppendCheckItem(wxID_ANY, wxT("Strip chart"));
+    m_menu_strip_chart = item->GetId();
+    item = m_popup_menu->AppendCheckItem(wxID_ANY, wxT("Auto scale"));
+    m_menu_autoscale = item->GetId();
     item = m_popup_menu->Append(wxID_ANY, wxT("Configure"));
     m_menu_plotconfig = item->GetId();
     
@@ -155,6 +239,11 @@ wxTrendPlot::wxTrendPlot(wxWindow* parent,
     m_x_axis_width = 10.0;
     m_zoom_factor = 1.0;
     
+    m_y_min = 0.0;
+    m_y_max = 5.0;
+    m_autoscale = false;
+    m_hysteresis = TREND_PLOT_DEFAULT_HYSTERESIS;
+    
     m_end_point = m_start_plot_x + m_x_axis_width;
     
     m_show_title = false;
@@ -177,6 +266,23 @@ wxTrendPlot::wxTrendPlot(wxWindow* parent,
 
 wxTrendPlot::~wxTrendPlot(void)
 {  
+    // Stop any producers that are still holding on to
+    // the queues from waiting for room in them.
+    for(size_t slot = m_data_sets.GetFirst();
+        slot != TREND_PLOT_INVALID_SLOT;
+        slot = m_data_sets.GetNext(slot))
+    {
+        wxTrendPlotQueue* queue = m_data_sets.Get(slot).m_queue.Get();
+        
+        if(queue != NULL)
+        {
+            queue->Close();
+        }
+    }
+
+    // The thread has to finish with the chrome before it goes
+    StopRenderThread();
+    DestroyChrome();
     delete m_delete_menu;
 }
 
@@ -200,188 +306,1373 @@ void wxTrendPlot::SetStatusText(const wxString& text)
     m_statusbar_owner->SetStatusText(text);
 }
 
-size_t wxTrendPlot::AddDataSet(const wxString& label, wxColour color)
+wxTrendPlotHandle wxTrendPlot::AddDataSet(const wxString&            label,
+                                          wxColour                   color,
+                                          size_t                     capacity,
+                                          const wxTrendPlotEncoding& encoding)
 {
-    wxTrendPlotDataset data;
-    data.m_color = color;
-    data.m_label = label;
-    
-    
-    wxMenuItem* item = m_delete_menu->Append(wxID_ANY, wxString(label));
-    data.m_delete_menu_id = item->GetId();
-    m_popup_menu->Enable(m_menu_delete_submenu, true);
-    
-    m_data_sets.push_back(data);
+    wxTrendPlotDataset* data = new wxTrendPlotDataset(capacity, encoding);
+    data->m_queue.Reset(new wxTrendPlotQueue());
     
-    return m_data_sets.size() - 1;
+    return InsertDataSet(data, label, color);
 }
 
 
-void wxTrendPlot::RemoveDataSet(std::vector<wxTrendPlotDataset>::iterator& match)
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddUniformDataSet()
+//|
+//| PARAMETERS:
+//|    label    (I) - The label of the data set.
+//|    color    (I) - The color of the data set.
+//|    x0       (I) - The x co-ordinate of sample 0.
+//|    dt       (I) - The distance between samples.
+//|    capacity (I) - The number of points kept before the oldest ones
+//|                   are discarded.
+//|    encoding (I) - How the y co-ordinates are stored.
+//|
+//| FUNCTION:
+//|    This method adds a data set that is sampled at a fixed rate. Only
+//|    the y co-ordinate of each point is stored.
+//|
+//| RETURNS:
+//|    The handle of the data set.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotHandle wxTrendPlot::AddUniformDataSet(const wxString&            label,
+                                                 wxColour                   color,
+                                                 double                     x0,
+                                                 double                     dt,
+                                                 size_t                     capacity,
+                                                 const wxTrendPlotEncoding& encoding)
 {
-    vector<wxTrendPlotDataset>::iterator iter;
-    for(iter = m_data_sets.begin();
-        iter != m_data_sets.end();
-        iter++)
-    {
-        if(iter == match)
-        {
-            m_delete_menu->Remove(iter->m_delete_menu_id);
-            m_data_sets.erase(iter);
-            
-            if(m_data_sets.size() == 0)
-            {
-                m_popup_menu->Enable(m_menu_delete_submenu, false);
-            }
-            
-            break;
-        }
-    }
+    wxTrendPlotDataset* data = new wxTrendPlotDataset(capacity, x0, dt, encoding);
+    data->m_queue.Reset(new wxTrendPlotQueue());
+    
+    return InsertDataSet(data, label, color);
 }
 
-bool wxTrendPlot::AddPoint(size_t set_handle, double x, double y)
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddFileDataSet()
+//|
+//| PARAMETERS:
+//|    path          (I) - The path of the file.
+//|    label         (I) - The label of the data set.
+//|    color         (I) - The color of the data set.
+//|    file_capacity (I) - The number of points a new file can hold.
+//|    capacity      (I) - The number of points kept in memory.
+//|
+//| FUNCTION:
+//|    This method adds a data set that records its points in a memory
+//|    mapped file. Reopening a file only reads its header and the points
+//|    kept in memory, and the plot follows on from the last point in it.
+//|    Points older than those kept in memory are drawn from the file, so
+//|    only the pages under the visible part of the plot are read.
+//|
+//| RETURNS:
+//|    The handle of the data set, which isn't valid if the file couldn't
+//|    be opened or doesn't have a single column.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotHandle wxTrendPlot::AddFileDataSet(const wxString& path,
+                                              const wxString& label,
+                                              wxColour        color,
+                                              size_t          file_capacity,
+                                              size_t          capacity)
 {
-    if(set_handle >= m_data_sets.size())
+    wxTrendPlotFile* file = new wxTrendPlotFile();
+    
+    if(!file->Open(path, 1, file_capacity))
     {
-        return false;
+        delete file;
+        return wxTrendPlotHandle();
     }
     
-    m_data_sets[set_handle].m_points[x] = y;
+    wxTrendPlotDataset* data = new wxTrendPlotDataset(capacity);
     
-    if(x > m_start_plot_x + (m_x_axis_width * 0.75))
+    // The file still belongs to us if the group won't take it
+    if(!data->GetGroup().SetFile(file))
     {
-        m_start_plot_x += .5;
+        delete data;
+        delete file;
+        return wxTrendPlotHandle();
     }
     
-    m_end_point = x + m_x_axis_width;
-
-    return true;
-}
-
-        
-void wxTrendPlot::OnContextMenu(wxContextMenuEvent& WXUNUSED(event))
-{
-    PopupMenu(m_popup_menu);
+    data->m_queue.Reset(new wxTrendPlotQueue());
+    
+    if(data->GetCount() != 0)
+    {
+        FollowPoint(data->GetX(data->GetCount() - 1));
+    }
+    
+    return InsertDataSet(data, label, color);
 }
 
 
 //+------------------------------------------------------------------------------
 //|
 //| NAME:
-//|    SetRenderer()
+//|    AddFrameGroup()
 //|
 //| PARAMETERS:
-//|    render (I) - The renderiing mode:
-//|                     RENDER_CAIRO_BUFFER
-//|                     RENDER_CAIRO_NATIVE
-//|                     RENDER_NATIVE
+//|    labels   (I) - The label of each data set.
+//|    colors   (I) - The color of each data set.
+//|    count    (I) - The number of data sets.
+//|    handles  (O) - The handle of each data set.
+//|    capacity (I) - The number of frames kept before the oldest ones
+//|                   are discarded.
+//|    encoding (I) - How the y co-ordinates of each data set are stored.
 //|
 //| FUNCTION:
-//|    This method is called to change the rendering mode for the demo app.
+//|    This method adds a group of data sets that are sampled together.
+//|    The data sets are columns of a single frame group so the x
+//|    co-ordinates are stored once for all of them and only have to be
+//|    converted to the screen once when they are drawn. They share a
+//|    queue whose frames have a y for each data set.
 //|
 //| RETURNS:
 //|    None.
 //|
 //+------------------------------------------------------------------------------
-void wxTrendPlot::SetRenderer(int renderer)
+void wxTrendPlot::AddFrameGroup(const wxString*            labels,
+                                const wxColour*            colors,
+                                size_t                     count,
+                                wxTrendPlotHandle*         handles,
+                                size_t                     capacity,
+                                const wxTrendPlotEncoding& encoding)
 {
-    m_renderer = renderer;
-    Refresh(false);
+    wxTrendPlotFrameGroupPtr group(new wxTrendPlotFrameGroup(capacity));
+    wxTrendPlotQueuePtr queue(new wxTrendPlotQueue(TREND_PLOT_DEFAULT_QUEUE_CAPACITY,
+                                                   TREND_PLOT_QUEUE_DROP_OLDEST,
+                                                   count));
+    
+    for(size_t index = 0; index < count; index++)
+    {
+        wxTrendPlotDataset* data = new wxTrendPlotDataset(group, encoding);
+        data->m_queue = queue;
+        
+        handles[index] = InsertDataSet(data, labels[index], colors[index]);
+    }
 }
 
 
-void wxTrendPlot::OnDoAction(wxCommandEvent& event)
+wxTrendPlotHandle wxTrendPlot::InsertDataSet(wxTrendPlotDataset* data,
+                                             const wxString&     label,
+                                             wxColour            color)
 {
-    if(m_menu_native_render == event.GetId())
+    data->m_color = color;
+    data->m_label = label;
+    
+    wxMenuItem* item = m_delete_menu->Append(wxID_ANY, wxString(label));
+    data->m_delete_menu_id = item->GetId();
+    m_popup_menu->Enable(m_menu_delete_submenu, true);
+    
+    wxTrendPlotHandle handle = m_data_sets.Add(data);
+    m_delete_menu_ids[data->m_delete_menu_id] = handle;
+    
+    // The legend needs to be redrawn
+    InvalidateChrome();
+    m_strip.Invalidate();
+    
+    return handle;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    RemoveDataSet()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of the data set.
+//|
+//| FUNCTION:
+//|    This method removes a data set from the plot. The other data sets
+//|    stay where they are so their handles are still valid, and the
+//|    handle of the data set removed no longer finds anything even if
+//|    its slot is re-used.
+//|
+//| RETURNS:
+//|    false if the handle is stale, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::RemoveDataSet(wxTrendPlotHandle set_handle)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL)
     {
-        SetRenderer(RENDER_NATIVE);
+        return false;
     }
-    else if(m_menu_cairo_render_buffer == event.GetId())
+    
+    m_delete_menu->Delete(data->m_delete_menu_id);
+    m_delete_menu_ids.erase(data->m_delete_menu_id);
+    
+    // Any producer still holding the queue stops here
+    wxTrendPlotQueuePtr queue = data->m_queue;
+    
+    if(queue.IsOk())
     {
-        SetRenderer(RENDER_CAIRO_BUFFER);
+        queue->Close();
     }
-    else if(m_menu_cairo_render_native == event.GetId())
+
+    m_data_sets.Remove(set_handle);
+    
+    // The frames of the queue of a frame group no longer match it,
+    // so the rest of the group is given a new queue.
+    if(queue.IsOk() && queue->GetColumnCount() > 1)
     {
-        SetRenderer(RENDER_CAIRO_NATIVE);
+        ReplaceQueue(queue);
     }
-    else if(m_menu_pause == event.GetId())
+    
+    InvalidateChrome();
+    m_strip.Invalidate();
+    
+    if(m_data_sets.GetCount() == 0)
     {
-        if(m_is_paused)
-        {
-            Pause(false);
-        }
-        else
-        {
-            Pause(true);
-        }
+        m_popup_menu->Enable(m_menu_delete_submenu, false);
     }
-    else if(m_menu_zoomin == event.GetId())
+    
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetRetention()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of the data set.
+//|    retention  (I) - The limits on the points kept.
+//|
+//| FUNCTION:
+//|    This method sets the retention policy of the frame group of a data
+//|    set, so it applies to every data set of the group. Points beyond
+//|    the new limits are evicted straight away. The count and byte limits
+//|    shrink the storage of the group, the span limit evicts points more
+//|    than the span behind the newest point as new points are added.
+//|
+//| RETURNS:
+//|    false if the handle is invalid, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::SetRetention(wxTrendPlotHandle           set_handle,
+                               const wxTrendPlotRetention& retention)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL)
     {
-        Zoom(2.0);
+        return false;
     }
-    else if(m_menu_zoomout == event.GetId())
+    
+    data->GetGroup().SetRetention(retention);
+    ReportEvictions(set_handle, *data);
+    
+    m_strip.Invalidate();
+    
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetArchive()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of the data set.
+//|    archive    (I) - Set to archive the points pushed out.
+//|
+//| FUNCTION:
+//|    This method turns the archive of the frame group of a data set on
+//|    or off. With it on, points pushed out of the group because it is
+//|    full are compressed into chunks instead of being discarded, so the
+//|    whole history can be panned back over. The span limit of the
+//|    retention policy still applies.
+//|
+//| RETURNS:
+//|    false if the handle is invalid, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::SetArchive(wxTrendPlotHandle set_handle, bool archive)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL)
     {
-        Zoom(0.5);
+        return false;
     }
-    else if(m_menu_plotconfig == event.GetId())
-    {
-       /*
-        XTrend_PlotConfig_Form* form = new XTrend_PlotConfig_Form(this, "Plot Configuration", &m_data_sets);
+    
+    data->GetGroup().SetArchive(archive);
+    ReportEvictions(set_handle, *data);
+    
+    m_strip.Invalidate();
+    
+    return true;
+}
 
-        form->ShowModal();
-        delete form;
-       */
-    }
-    else
-    {
-        vector<wxTrendPlotDataset>::iterator iter;
 
-        if(m_data_sets.size() > 1)
-        {
-            for(iter = m_data_sets.begin();
-                iter != m_data_sets.end();
-                iter++)
-            {
-                if(iter->m_delete_menu_id == event.GetId())
-                {
-                    RemoveDataSet(iter);
-                    break;
-                }
-            }
-        }
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetEvictedCount()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of the data set.
+//|
+//| FUNCTION:
+//|    This method returns the number of points that have been discarded
+//|    from a data set, either because it was full or because of its
+//|    retention policy.
+//|
+//| RETURNS:
+//|    The number of points, 0 if the handle is invalid.
+//|
+//+------------------------------------------------------------------------------
+wxUint64 wxTrendPlot::GetEvictedCount(wxTrendPlotHandle set_handle)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL)
+    {
+        return 0;
     }
+    
+    return data->GetGroup().GetEvictedCount();
 }
 
 
-void wxTrendPlot::Pause(bool pause)
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ReportEvictions()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of the data set points were added to.
+//|    data       (I) - The data set.
+//|
+//| FUNCTION:
+//|    This method calls the eviction callback if any points have been
+//|    evicted from the frame group of a data set since it was last
+//|    called. The group is only reported once, through the data set
+//|    that the points were added to.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::ReportEvictions(wxTrendPlotHandle set_handle, wxTrendPlotDataset& data)
 {
-    m_is_paused = pause;
-
-    if(m_is_paused)
+    wxUint64 count = data.GetGroup().TakeEvicted();
+    
+    if(count != 0 && m_eviction_callback != NULL)
     {
-        SetStatusText(wxT("Paused"));
-        m_pause_point = m_start_plot_x;
+        m_eviction_callback(set_handle, count, m_eviction_context);
     }
-    else
+}
+
+bool wxTrendPlot::AddPoint(wxTrendPlotHandle set_handle, double x, double y)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL || data->IsShared())
     {
-        SetStatusText(wxT(""));
+        return false;
     }
+    
+    InvalidateStrip(*data, x);
+    data->AddPoint(x, y);
+    ReportEvictions(set_handle, *data);
+    FollowPoint(x);
 
-    m_popup_menu->Check(m_menu_pause, pause);
+    return true;
 }
 
 
-void wxTrendPlot::UpdatePlot(void)
-{
-    wxRect rect = GetClientRect();
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddPoints()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of the data set.
+//|    x          (I) - The x co-ordinates of the points.
+//|    y          (I) - The y co-ordinates of the points.
+//|    count      (I) - The number of points.
+//|
+//| FUNCTION:
+//|    This method adds a block of points to a data set, for example a
+//|    buffer read from an acquisition card. The data set copies the
+//|    points in as a block and the plot is only scrolled once for the
+//|    whole block.
+//|
+//| RETURNS:
+//|    false if the handle is invalid or the data set shares a frame
+//|    group, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::AddPoints(wxTrendPlotHandle set_handle,
+                            const double*     x,
+                            const double*     y,
+                            size_t            count)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL || data->IsShared())
+    {
+        return false;
+    }
+    
+    // The group of the data set has a single column so each
+    // point is a frame.
+    return AddFrames(set_handle, x, y, count);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddRow()
+//|
+//| PARAMETERS:
+//|    x     (I) - The x co-ordinate shared by the points.
+//|    y     (I) - The y co-ordinate of the point for each data set.
+//|    count (I) - The number of y co-ordinates, which can't be more
+//|                than the number of data sets.
+//|
+//| FUNCTION:
+//|    This method adds a point with the same x co-ordinate to each of
+//|    the first count data sets, in the order they were added, for
+//|    example a sample of each channel of a data logger. Data sets that
+//|    share a frame group have to be added to with AddFrame() instead.
+//|
+//| RETURNS:
+//|    false if there are more points than data sets or one of the data
+//|    sets shares a frame group, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::AddRow(double x, const double* y, size_t count)
+{
+    if(count > m_data_sets.GetCount())
+    {
+        return false;
+    }
+    
+    size_t slot = m_data_sets.GetFirst();
+    
+    for(size_t index = 0; index < count; index++)
+    {
+        if(m_data_sets.Get(slot).IsShared())
+        {
+            return false;
+        }
+        
+        slot = m_data_sets.GetNext(slot);
+    }
+    
+    slot = m_data_sets.GetFirst();
+    
+    for(size_t index = 0; index < count; index++)
+    {
+        wxTrendPlotDataset& data = m_data_sets.Get(slot);
+        
+        InvalidateStrip(data, x);
+        data.AddPoint(x, y[index]);
+        ReportEvictions(m_data_sets.GetHandle(slot), data);
+        
+        slot = m_data_sets.GetNext(slot);
+    }
+    
+    FollowPoint(x);
+    
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddFrame()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of any data set of the group.
+//|    x          (I) - The x co-ordinate of the frame.
+//|    y          (I) - The y co-ordinate for each data set of the group
+//|                     in the order they were added.
+//|
+//| FUNCTION:
+//|    This method adds a frame to a group of data sets that are sampled
+//|    together. The x co-ordinate is only stored once for the group.
+//|
+//| RETURNS:
+//|    false if the handle is invalid, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::AddFrame(wxTrendPlotHandle set_handle, double x, const double* y)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL)
+    {
+        return false;
+    }
+    
+    InvalidateStrip(*data, x);
+    data->GetGroup().AddFrame(x, y);
+    ReportEvictions(set_handle, *data);
+    FollowPoint(x);
+    
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddFrames()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of any data set of the group.
+//|    x          (I) - The x co-ordinates of the frames.
+//|    y          (I) - The y co-ordinates of the frames, one for each data
+//|                     set of the group followed by the next frame and
+//|                     so on.
+//|    count      (I) - The number of frames.
+//|
+//| FUNCTION:
+//|    This method adds a block of frames to a group of data sets. The
+//|    group copies the frames in as a block and the plot is only
+//|    scrolled once for the whole block.
+//|
+//| RETURNS:
+//|    false if the handle is invalid, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::AddFrames(wxTrendPlotHandle set_handle,
+                            const double*     x,
+                            const double*     y,
+                            size_t            count)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL)
+    {
+        return false;
+    }
+    
+    if(count == 0)
+    {
+        return true;
+    }
+    
+    double min_x = x[0];
+    double max_x = x[0];
+    
+    for(size_t index = 1; index < count; index++)
+    {
+        if(x[index] < min_x)
+        {
+            min_x = x[index];
+        }
+        else if(x[index] > max_x)
+        {
+            max_x = x[index];
+        }
+    }
+    
+    InvalidateStrip(*data, min_x);
+    data->GetGroup().AddFrames(x, y, count);
+    ReportEvictions(set_handle, *data);
+    FollowPoint(max_x);
+    
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddSamples()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of the data set.
+//|    y          (I) - The y co-ordinates of the samples.
+//|    count      (I) - The number of samples.
+//|
+//| FUNCTION:
+//|    This method adds the next samples to a data set that is sampled at
+//|    a fixed rate. The samples follow on from the last point.
+//|
+//| RETURNS:
+//|    false if the handle is invalid or the data set isn't sampled at a
+//|    fixed rate, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::AddSamples(wxTrendPlotHandle set_handle,
+                             const double*     y,
+                             size_t            count)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL || !data->GetGroup().IsUniform())
+    {
+        return false;
+    }
+    
+    if(count == 0)
+    {
+        return true;
+    }
+    
+    InvalidateStrip(*data, data->GetGroup().GetNextX());
+    data->GetGroup().AddSamples(y, count);
+    FollowPoint(data->GetX(data->GetCount() - 1));
+    ReportEvictions(set_handle, *data);
+    
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    InvalidateStrip()
+//|
+//| PARAMETERS:
+//|    data (I) - The data set points are being added to.
+//|    x    (I) - The smallest x co-ordinate being added.
+//|
+//| FUNCTION:
+//|    This method is called before adding points to a data set. The strip
+//|    chart has to draw the line from the point before the new ones again.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::InvalidateStrip(const wxTrendPlotDataset& data, double x)
+{
+    if(!m_strip_chart)
+    {
+        return;
+    }
+    
+    double from_x = x;
+    size_t first;
+    size_t last;
+    
+    if(data.FindRange(x, x, first, last) && data.GetX(first) < x)
+    {
+        from_x = data.GetX(first);
+    }
+    
+    m_strip.InvalidateFrom(from_x);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FollowPoint()
+//|
+//| PARAMETERS:
+//|    x (I) - The largest x co-ordinate that was added.
+//|
+//| FUNCTION:
+//|    This method scrolls the plot to keep the newest point in view once
+//|    it passes three quarters of the way along the x axis. The plot
+//|    normally moves along in steps of half a unit but takes as many as
+//|    are needed to catch up with a block of points. A strip chart
+//|    scrolls smoothly so that each frame only has to draw the columns
+//|    that have come into view.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::FollowPoint(double x)
+{
+    double follow_x = m_start_plot_x + (m_x_axis_width * 0.75);
+    
+    if(x > follow_x)
+    {
+        if(m_strip_chart)
+        {
+            m_start_plot_x = x - (m_x_axis_width * 0.75);
+        }
+        else
+        {
+            m_start_plot_x += ceil((x - follow_x) / .5) * .5;
+        }
+    }
+    
+    m_end_point = x + m_x_axis_width;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetQueue()
+//|
+//| PARAMETERS:
+//|    set_handle (I) - The handle of the data set.
+//|
+//| FUNCTION:
+//|    This method returns the queue used to add points to a data set from
+//|    other threads. It must be called from the GUI thread, but the
+//|    queue can then be handed to any number of producer threads. The
+//|    points pushed onto it are added to the plot by the GUI thread
+//|    when it is idle and before each frame is painted. Once the data
+//|    set is removed the queue is closed and any points pushed onto it
+//|    are dropped.
+//|
+//|    The data sets of a frame group share a queue of whole frames. When
+//|    one of them is removed the queue is closed and the rest of the
+//|    group gets a new queue, which has to be fetched again.
+//|
+//| RETURNS:
+//|    The queue or an empty pointer if the handle is invalid.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotQueuePtr wxTrendPlot::GetQueue(wxTrendPlotHandle set_handle)
+{
+    wxTrendPlotDataset* data = m_data_sets.Find(set_handle);
+    
+    if(data == NULL)
+    {
+        return wxTrendPlotQueuePtr();
+    }
+    
+    return data->m_queue;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ReplaceQueue()
+//|
+//| PARAMETERS:
+//|    old_queue (I) - The closed queue of a frame group.
+//|
+//| FUNCTION:
+//|    This method gives the data sets left in a frame group a new queue
+//|    once one of them has been removed. The frames left in the old
+//|    queue are dropped since they have a y for the removed data set.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::ReplaceQueue(const wxTrendPlotQueuePtr& old_queue)
+{
+    wxTrendPlotQueuePtr queue(new wxTrendPlotQueue(old_queue->GetCapacity(),
+                                                   old_queue->GetPolicy(),
+                                                   old_queue->GetColumnCount() - 1));
+    
+    for(size_t slot = m_data_sets.GetFirst();
+        slot != TREND_PLOT_INVALID_SLOT;
+        slot = m_data_sets.GetNext(slot))
+    {
+        wxTrendPlotDataset& data = m_data_sets.Get(slot);
+        
+        if(data.m_queue == old_queue)
+        {
+            data.m_queue = queue;
+        }
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrainQueues()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method adds the frames waiting in the queue of each data set
+//|    to the plot. Each queue is popped into a block that is added in
+//|    one go, so the data set is only looked up and the plot scrolled
+//|    once per block. At most TREND_PLOT_DRAIN_BATCH frames are taken
+//|    off each queue so a busy producer can't hold up the GUI, and if
+//|    any are left another idle event is asked for to carry on.
+//|
+//|    The data sets of a frame group share their queue, so it is all
+//|    drained through the first of them.
+//|
+//| RETURNS:
+//|    true if any points were added.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::DrainQueues(void)
+{
+    bool added = false;
+    bool more = false;
+    
+    for(size_t slot = m_data_sets.GetFirst();
+        slot != TREND_PLOT_INVALID_SLOT;
+        slot = m_data_sets.GetNext(slot))
+    {
+        wxTrendPlotDataset& data = m_data_sets.Get(slot);
+        wxTrendPlotQueue* queue = data.m_queue.Get();
+        
+        if(queue == NULL)
+        {
+            continue;
+        }
+        
+        // Clear the flag before emptying the queue so that any
+        // point pushed from here on wakes us up again.
+        queue->TakeReady();
+        
+        m_drain_x.resize(TREND_PLOT_DRAIN_BATCH);
+        m_drain_y.resize(TREND_PLOT_DRAIN_BATCH * queue->GetColumnCount());
+        
+        size_t count = queue->Pop(&m_drain_x[0], &m_drain_y[0], TREND_PLOT_DRAIN_BATCH);
+        
+        if(count == 0)
+        {
+            continue;
+        }
+        
+        wxTrendPlotHandle handle = m_data_sets.GetHandle(slot);
+        
+        if(data.IsShared())
+        {
+            AddFrames(handle, &m_drain_x[0], &m_drain_y[0], count);
+        }
+        else
+        {
+            AddPoints(handle, &m_drain_x[0], &m_drain_y[0], count);
+        }
+        
+        added = true;
+        
+        if(count == TREND_PLOT_DRAIN_BATCH)
+        {
+            more = true;
+        }
+    }
+    
+    if(more)
+    {
+        wxWakeUpIdle();
+    }
+    
+    return added;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    OnIdle()
+//|
+//| PARAMETERS:
+//|    event (I) - The idle event.
+//|
+//| FUNCTION:
+//|    This method is called when the event loop is idle, which includes
+//|    when a producer thread pushes a point onto an empty queue or the
+//|    render thread finishes a frame. The queues are emptied and a frame
+//|    is requested if anything changed, and the plot is repainted if the
+//|    render thread has finished a frame.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::OnIdle(wxIdleEvent& event)
+{
+    if(DrainQueues())
+    {
+        UpdatePlot();
+    }
+    
+    // Refresh() would hand the thread another scene, so the
+    // window is invalidated directly.
+    if(m_render_thread != NULL && m_render_thread->IsFresh())
+    {
+        wxScrolledWindow::Refresh(false);
+    }
+    
+    event.Skip();
+}
+
+        
+void wxTrendPlot::OnContextMenu(wxContextMenuEvent& WXUNUSED(event))
+{
+    PopupMenu(m_popup_menu);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetRenderer()
+//|
+//| PARAMETERS:
+//|    render (I) - The renderiing mode:
+//|                     RENDER_CAIRO_BUFFER
+//|                     RENDER_CAIRO_NATIVE
+//|                     RENDER_CAIRO_THREAD
+//|                     RENDER_NATIVE
+//|
+//| FUNCTION:
+//|    This method is called to change the rendering mode for the demo app.
+//|    The render thread used by RENDER_CAIRO_THREAD is started when the
+//|    mode is selected and stopped when it is left. If the thread can't
+//|    be started RENDER_CAIRO_BUFFER is used instead. The thread always
+//|    draws the whole of each line, so a strip chart is drawn like any
+//|    other plot in this mode and is only scrolled again once one of the
+//|    other cairo modes is selected.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::SetRenderer(int renderer)
+{
+    if(renderer == RENDER_CAIRO_THREAD)
+    {
+        if(m_render_thread == NULL)
+        {
+            m_render_thread = new wxTrendPlotRenderer(&m_tiles);
+            
+            if(!m_render_thread->Start())
+            {
+                delete m_render_thread;
+                m_render_thread = NULL;
+                
+                renderer = RENDER_CAIRO_BUFFER;
+                m_popup_menu->Check(m_menu_cairo_render_buffer, true);
+            }
+        }
+    }
+    else
+    {
+        StopRenderThread();
+    }
+    
+    m_renderer = renderer;
+    
+    // Release the off-screen buffer when it isn't being used
+    if(m_renderer != RENDER_CAIRO_BUFFER && m_renderer != RENDER_CAIRO_THREAD)
+    {
+        m_buffer.Resize(0, 0);
+    }
+    
+    // The cached parts of the plot are created to match the
+    // surface being drawn on so they have to be re-created.
+    DestroyChrome();
+    m_strip.Destroy();
+    
+    Refresh(false);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    StopRenderThread()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method stops and deletes the render thread if it is running.
+//|    It waits for the thread to finish the frame it is drawing.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::StopRenderThread(void)
+{
+    if(m_render_thread != NULL)
+    {
+        m_render_thread->Stop();
+        delete m_render_thread;
+        m_render_thread = NULL;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetTileThreads()
+//|
+//| PARAMETERS:
+//|    threads (I) - The number of worker threads, or 0 to draw the lines
+//|                  on one thread.
+//|
+//| FUNCTION:
+//|    This method changes the number of threads the lines are drawn with.
+//|    The frames look exactly the same either way, tiles only change how
+//|    quickly they are drawn, so wxThread::GetCPUCount() - 1 threads is
+//|    a sensible choice for large plots.
+//|
+//| RETURNS:
+//|    false if the threads couldn't be started, in which case the lines
+//|    are drawn on one thread.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlot::SetTileThreads(int threads)
+{
+    bool started = m_tiles.SetThreadCount(threads);
+    
+    Refresh(false);
+    
+    return started;
+}
+
+
+void wxTrendPlot::OnDoAction(wxCommandEvent& event)
+{
+    if(m_menu_native_render == event.GetId())
+    {
+        SetRenderer(RENDER_NATIVE);
+    }
+    else if(m_menu_cairo_render_buffer == event.GetId())
+    {
+        SetRenderer(RENDER_CAIRO_BUFFER);
+    }
+    else if(m_menu_cairo_render_native == event.GetId())
+    {
+        SetRenderer(RENDER_CAIRO_NATIVE);
+    }
+    else if(m_menu_cairo_render_thread == event.GetId())
+    {
+        SetRenderer(RENDER_CAIRO_THREAD);
+    }
+    else if(m_menu_pause == event.GetId())
+    {
+        if(m_is_paused)
+        {
+            Pause(false);
+        }
+        else
+        {
+            Pause(true);
+        }
+    }
+    else if(m_menu_strip_chart == event.GetId())
+    {
+        SetStripChart(event.IsChecked());
+    }
+    else if(m_menu_autoscale == event.GetId())
+    {
+        SetAutoScale(event.IsChecked(), m_hysteresis);
+    }
+    else if(m_menu_zoomin == event.GetId())
+    {
+        Zoom(2.0);
+    }
+    else if(m_menu_zoomout == event.GetId())
+    {
+        Zoom(0.5);
+    }
+    else if(m_menu_plotconfig == event.GetId())
+    {
+       /*
+        XTrend_PlotConfig_Form* form = new XTrend_PlotConfig_Form(this, "Plot Configuration", &m_data_sets);
+
+        form->ShowModal();
+        delete form;
+       */
+    }
+    else
+    {
+        wxTrendPlotMenuMap::iterator iter = m_delete_menu_ids.find(event.GetId());
+
+        if(iter != m_delete_menu_ids.end() && m_data_sets.GetCount() > 1)
+        {
+            RemoveDataSet(iter->second);
+        }
+    }
+}
+
+
+void wxTrendPlot::Pause(bool pause)
+{
+    m_is_paused = pause;
+
+    if(m_is_paused)
+    {
+        SetStatusText(wxT("Paused"));
+        m_pause_point = m_start_plot_x;
+    }
+    else
+    {
+        SetStatusText(wxT(""));
+    }
+
+    m_popup_menu->Check(m_menu_pause, pause);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetAutoScale()
+//|
+//| PARAMETERS:
+//|    autoscale  (I) - Set to scale the y axis to the visible points.
+//|    hysteresis (I) - The fraction of the axis that may go unused
+//|                     before it is rescaled.
+//|
+//| FUNCTION:
+//|    This method turns the autoscaling of the y axis on or off. While
+//|    it is off the y axis keeps the range it last had.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::SetAutoScale(bool autoscale, double hysteresis)
+{
+    if(!(hysteresis >= 0))
+    {
+        hysteresis = 0;
+    }
+    else if(hysteresis > 1)
+    {
+        hysteresis = 1;
+    }
+    
+    m_autoscale = autoscale;
+    m_hysteresis = hysteresis;
+    m_popup_menu->Check(m_menu_autoscale, autoscale);
+    
+    Refresh(false);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetYRange()
+//|
+//| PARAMETERS:
+//|    min_y (I) - The y value at the bottom of the plot.
+//|    max_y (I) - The y value at the top of the plot.
+//|
+//| FUNCTION:
+//|    This method fixes the range of the y axis and turns off the
+//|    autoscaling. An empty range is ignored.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::SetYRange(double min_y, double max_y)
+{
+    if(!(max_y > min_y))
+    {
+        return;
+    }
+    
+    m_autoscale = false;
+    m_popup_menu->Check(m_menu_autoscale, false);
+    
+    SetYAxis(min_y, max_y);
+    Refresh(false);
+}
+
+
+void wxTrendPlot::SetYAxis(double min_y, double max_y)
+{
+    if(min_y == m_y_min && max_y == m_y_max)
+    {
+        return;
+    }
+    
+    m_y_min = min_y;
+    m_y_max = max_y;
+    
+    // The y axis labels and anything already drawn are now wrong
+    InvalidateChrome();
+    m_strip.Invalidate();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AutoScale()
+//|
+//| PARAMETERS:
+//|    start_x (I) - The x value at the left hand side of the plot.
+//|
+//| FUNCTION:
+//|    This method scales the y axis to fit the points that are visible.
+//|    The range of the visible points of each data set is kept up to date
+//|    as the plot scrolls and points arrive, so this doesn't depend on
+//|    the number of points. The axis is left alone while the points fit
+//|    inside it and fill enough of it, and when it does change it is
+//|    given a margin of the hysteresis so that small changes in the range
+//|    of the points don't rescale it again. Points only held in the file
+//|    or the archive of a data set aren't included.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::AutoScale(double start_x)
+{
+    if(!m_autoscale)
+    {
+        return;
+    }
+    
+    double end_x = start_x + m_x_axis_width;
+    bool   found = false;
+    double low = 0;
+    double high = 0;
+    
+    for(size_t slot = m_data_sets.GetFirst();
+        slot != TREND_PLOT_INVALID_SLOT;
+        slot = m_data_sets.GetNext(slot))
+    {
+        wxTrendPlotDataset& data = m_data_sets.Get(slot);
+        
+        data.m_range.Update(data.GetGroup(), &data.GetColumn(), start_x, end_x);
+        
+        if(data.m_range.IsEmpty())
+        {
+            continue;
+        }
+        
+        if(!found || data.m_range.GetMin() < low)
+        {
+            low = data.m_range.GetMin();
+        }
+        
+        if(!found || data.m_range.GetMax() > high)
+        {
+            high = data.m_range.GetMax();
+        }
+        
+        found = true;
+    }
+    
+    if(!found)
+    {
+        return;
+    }
+    
+    double span = high - low;
+    
+    if(low >= m_y_min &&
+       high <= m_y_max &&
+       span >= (m_y_max - m_y_min) * (1 - m_hysteresis))
+    {
+        return;
+    }
+    
+    double margin = span * m_hysteresis / 2;
+    
+    // A flat line still needs an axis
+    if(span == 0)
+    {
+        margin = (low == 0) ? 0.5 : fabs(low) * 0.1;
+    }
+    
+    SetYAxis(low - margin, high + margin);
+}
 
-    // If the graph is currently not exposed then don't
-    // draw it un-necessarily. Otherwise we waste processor
-    // cycles for nothing.
-    //if(IsExposed(rect.x, rect.y, rect.width, rect.height))
-    //{
-        Refresh(false);
-    //}
+
+void wxTrendPlot::UpdatePlot(void)
+{
+    // Requests to repaint the plot are coalesced so that adding
+    // points quickly doesn't flood the event loop with paints.
+    m_scheduler.RequestFrame();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Refresh()
+//|
+//| PARAMETERS:
+//|    erase_background (I) - Set to erase the background first.
+//|    rect             (I) - The part of the window to repaint, or NULL
+//|                           for all of it.
+//|
+//| FUNCTION:
+//|    This method repaints the plot. With RENDER_CAIRO_THREAD nothing is
+//|    painted here; a new scene is handed to the render thread instead
+//|    and the window is repainted from OnIdle() once the thread has
+//|    drawn it.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::Refresh(bool erase_background, const wxRect* rect)
+{
+    if(m_render_thread == NULL)
+    {
+        wxScrolledWindow::Refresh(erase_background, rect);
+        return;
+    }
+    
+    SubmitScene();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SubmitScene()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method reduces the data sets to a scene and hands it to the
+//|    render thread. It never waits for the thread to draw a frame. As
+//|    far as the frame scheduler is concerned the frame is finished once
+//|    the scene has been submitted.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::SubmitScene(void)
+{
+    m_scheduler.FrameRendered();
+    
+    // Pick up any points posted since the plot was last idle
+    DrainQueues();
+    
+    wxRect rect = GetClientRect();
+    
+    if(rect.width == 0 || rect.height == 0)
+    {
+        return;
+    }
+    
+    BuildScene(m_render_thread->GetContext(),
+               rect,
+               m_is_paused ? m_pause_point : m_start_plot_x,
+               true);
+    m_render_thread->Submit(m_scene);
+    
+    // Keep the scene that came back but not its chrome
+    m_scene.ReleaseChrome();
 }
 
 
@@ -401,11 +1692,6 @@ void wxTrendPlot::Draw(bool     use_cairo,
     if(use_cairo)
     {
         cairo_t* cairo_image = (cairo_t*)drawer;
-
-        // Clear the background and set it to white
-        cairo_set_source_rgb (cairo_image, 1, 1, 1);
-        cairo_rectangle(cairo_image, 0, 0, rect.width, rect.height);
-        cairo_fill(cairo_image);
        
         // If the start point wasn't overridden then use the stored
         // start point for this plot
@@ -420,15 +1706,70 @@ void wxTrendPlot::Draw(bool     use_cairo,
                 start_x = m_start_plot_x;
             }
         }
-    
+        
+        // Work out the frame. A strip chart draws its lines into the
+        // ring of columns instead of the scene.
+        BuildScene(cairo_image, rect, start_x, !m_strip_chart);
+        
+        m_scene.DrawBackground(cairo_image);
+        
+        if(m_strip_chart)
+        {
+            const wxRect& graph = m_scene.GetGraph();
+            int min_x = graph.x;
+            int max_x = graph.x + graph.width;
+            int min_y = graph.y + graph.height;
+            int max_y = graph.y;
+            
+            DrawStrip(cairo_image,
+                      start_x,
+                      min_x,
+                      max_x,
+                      min_y,
+                      max_y,
+                      m_x_axis_width / (max_x - min_x),
+                      -((m_y_max - m_y_min) / (max_y - min_y)));
+        }
+        else if(!m_tiles.DrawLines(m_scene, cairo_image))
+        {
+            m_scene.DrawLines(cairo_image);
+        }
+        
+        m_scene.DrawForeground(cairo_image);
+        
+        // Let go of the chrome so that it can be redrawn in place
+        m_scene.ReleaseChrome();
+        
+        return;
+    }
+    else
+    {
+        wxDC* dc = (wxDC*)drawer;
+        
+        // If the start point wasn't overridden then use the stored
+        // start point for this plot
+        if(start_x == 0)
+        {
+            if(m_is_paused)
+            {
+                start_x = m_pause_point;
+            }
+            else
+            {
+                start_x = m_start_plot_x;
+            }
+        }
+        
+        AutoScale(start_x);
+        
         int bottom_pad = 50;
         int top_pad    = 40;
-        int left_pad   = 60;
+        int left_pad   = 50;
         int right_pad  = 20;
-        int number_x_data_points = 20;
-        int number_y_data_points = 20;
         double x_range = m_x_axis_width;
-        double y_range = 5.0;
+        double y_range = m_y_max - m_y_min;
+        wxPen pen;
+        wxFont font;
         
         if(!m_show_title)
         {
@@ -437,667 +1778,1493 @@ void wxTrendPlot::Draw(bool     use_cairo,
         
         if(!m_show_x_axis_title)
         {
-            bottom_pad = 45;
+            bottom_pad = 25;
         }
-    
+        
         if(!m_show_y_axis_title)
         {
             left_pad = 45;
-            right_pad = 45;
         }
         
-        // If the legend is enabled then calculate the space we require
-        // on the right hand side of the graph
         if(m_show_legend)
         {
-            int text_extent = 0;
-            cairo_text_extents_t extents;
+            font.SetFamily(wxFONTFAMILY_ROMAN);
+            font.SetPointSize(8);
+            dc->SetFont(font);
             
-            cairo_select_font_face(cairo_image, "Times",
-                                   CAIRO_FONT_SLANT_NORMAL,
-                                   CAIRO_FONT_WEIGHT_NORMAL);
-            cairo_set_font_size (cairo_image, 8 + 2);
+            int text_extent = 0;
+            wxCoord width;
+            wxCoord height;
             
-            cairo_text_extents (cairo_image, "Legend:", &extents);
+            dc->GetTextExtent(wxT("Legend:"),
+                             &width, &height, 0, 0, &font);
                 
-            if(extents.width > text_extent)
+            if(width > text_extent)
             {
-                text_extent = extents.width;
+                text_extent = width;
             }
                 
-            for(size_t index = 0; index < m_data_sets.size(); index++)
+            for(size_t slot = m_data_sets.GetFirst();
+                slot != TREND_PLOT_INVALID_SLOT;
+                slot = m_data_sets.GetNext(slot))
             {
-                cairo_text_extents (cairo_image,
-                                    m_data_sets[index].m_label.char_str(),
-                                    &extents);  
+                dc->GetTextExtent(m_data_sets.Get(slot).m_label,
+                                 &width, &height, 0, 0, &font);
                 
-                if(extents.width > text_extent)
+                if(width > text_extent)
                 {
-                    text_extent = extents.width;
+                    text_extent = width;
                 }
             }
             
             right_pad = text_extent + 50;
         }
         
-        // Draw a black border around the graph
-        cairo_set_line_width(cairo_image, 0.7);
-        cairo_set_source_rgb (cairo_image, 0, 0, 0);
-        cairo_rectangle(cairo_image,
-                        rect.x + left_pad,
-                        rect.y + top_pad,
-                        rect.width - left_pad - right_pad,
-                        rect.height - top_pad - bottom_pad);
-        cairo_stroke (cairo_image);
+        int width = rect.width - left_pad - right_pad;
+        int height = rect.height - top_pad - bottom_pad;
+        
+        font.SetFamily(wxFONTFAMILY_ROMAN);
+        font.SetPointSize(8);
+        dc->SetFont(font);
+        
+        // Place the ticks along the y axis and make room for the
+        // widest of their labels.
+        m_y_ticks.Update(m_y_min, m_y_max, height, TREND_PLOT_Y_TICK_SPACING);
+        
+        for(size_t tick = 0; tick < m_y_ticks.GetCount(); tick++)
+        {
+            const wxTrendPlotTickLabel& label = MeasureLabel(dc,
+                                                             m_y_ticks,
+                                                             m_y_ticks.GetValue(tick));
+            int label_pad = (int)ceil(label.width) + 10;
+            
+            if(m_show_y_axis_title)
+            {
+                label_pad += 20;
+            }
+            
+            if(label_pad > left_pad)
+            {
+                width -= label_pad - left_pad;
+                left_pad = label_pad;
+            }
+        }
+        
+        m_x_ticks.Update(start_x, start_x + x_range, width, TREND_PLOT_X_TICK_SPACING);
+        
+        pen.SetColour(0x0, 0x0, 0x0);
+        dc->SetPen(pen);
+        
+        dc->SetBrush( *wxWHITE_BRUSH);
+        dc->DrawRectangle(
+            rect.x + left_pad,
+            rect.y + top_pad,
+            width,
+            height);
+        
+        // Draw the grid at the ticks inside the border
+        pen.SetColour(0xE0, 0xE0, 0xE0);
+        dc->SetPen(pen);
+        
+        for(size_t tick = 0; tick < m_x_ticks.GetCount(); tick++)
+        {
+            int x = rect.x + left_pad + (int)((m_x_ticks.GetValue(tick) - start_x) * width / x_range);
+            
+            if(x > rect.x + left_pad && x < rect.x + left_pad + width - 1)
+            {
+                dc->DrawLine(x, rect.y + top_pad + 1,
+                             x, rect.y + top_pad + height - 1);
+            }
+        }
+        
+        for(size_t tick = 0; tick < m_y_ticks.GetCount(); tick++)
+        {
+            int y = rect.y + top_pad + height - (int)((m_y_ticks.GetValue(tick) - m_y_min) * height / y_range);
+            
+            if(y > rect.y + top_pad && y < rect.y + top_pad + height - 1)
+            {
+                dc->DrawLine(rect.x + left_pad + 1, y,
+                             rect.x + left_pad + width - 1, y);
+            }
+        }
+        
+        
+        pen.SetColour(0x0, 0x0, 0xFF);
+        dc->SetPen(pen);
+        
+        int min_x = rect.x + left_pad;
+        int max_x = rect.x - right_pad + rect.width;
+        int min_y = rect.y + rect.height - bottom_pad;
+        int max_y = rect.y + top_pad;
+        
+        double x_increment = x_range / (max_x - min_x);
+        double y_increment = -(y_range / (max_y - min_y));
+        
+        // Lines that are entirely outside of this area aren't drawn
+        wxRect visible(min_x, max_y, max_x - min_x, min_y - max_y);
+        visible.Inflate(1, 1);
+        
+        // Only let the lines draw inside the graph
+        if(m_clip)
+        {
+            dc->SetClippingRegion(min_x, max_y, max_x - min_x, min_y - max_y);
+        }
+        
+        ResetScreenX();
+        
+        for(size_t slot = m_data_sets.GetFirst();
+            slot != TREND_PLOT_INVALID_SLOT;
+            slot = m_data_sets.GetNext(slot))
+        {
+            const wxTrendPlotDataset& data = m_data_sets.Get(slot);
+            
+            pen.SetColour(data.m_color.Red(),
+                          data.m_color.Green(),
+                          data.m_color.Blue());
+            dc->SetPen(pen);
+            
+            const vector<wxPoint>& points = DecimateDataSet(data,
+                                                            start_x,
+                                                            min_x,
+                                                            max_x,
+                                                            min_y,
+                                                            x_increment,
+                                                            y_increment,
+                                                            true);
+            if(points.empty())
+            {
+                continue;
+            }
+            
+            int last_code = wxTrendPlotScene::GetOutCode(points[0], visible);
+            
+            for(size_t point = 1; point < points.size(); point++)
+            {
+                int code = wxTrendPlotScene::GetOutCode(points[point], visible);
+                
+                if(!wxTrendPlotScene::IsHidden(code, last_code))
+                {
+                    dc->DrawLine(points[point - 1].x,
+                                 points[point - 1].y,
+                                 points[point].x,
+                                 points[point].y);
+                }
+                
+                last_code = code;
+            }
+        }
+        
+        if(m_clip)
+        {
+            dc->DestroyClippingRegion();
+        }
+        else
+        {
+            pen.SetColour(0xFF, 0xFF, 0xFF);
+            dc->SetPen(pen);
+            dc->SetBrush( *wxWHITE_BRUSH);
+            
+            // Over-write the right hand side of the graph
+            dc->DrawRectangle(
+                rect.x + rect.width - right_pad,
+                rect.y,
+                rect.x + rect.width,
+                rect.y + rect.height);
+            
+            // Over-write the left hand side of the graph
+            dc->DrawRectangle(
+                rect.x,
+                rect.y,
+                rect.x + left_pad,
+                rect.y + rect.height);
+            
+            // Over-write the top part of the graph
+            dc->DrawRectangle(
+                rect.x,
+                rect.y,
+                rect.x + rect.width,
+                rect.y + top_pad);
+            
+            // Over-write the bottom part of the graph
+            dc->DrawRectangle(
+                rect.x,
+                rect.y + rect.height - bottom_pad,
+                rect.x + rect.width,
+                rect.y + rect.height);
+        }
+        
+        
+        
+        font.SetFamily(wxFONTFAMILY_ROMAN);
+        font.SetPointSize(8);
+        dc->SetFont(font);
+        
+        // Now draw the labels
+        pen.SetColour(0xA0, 0xA0, 0xA0);
+        dc->SetPen(pen);
+        
+        for(size_t tick = 0; tick < m_x_ticks.GetCount(); tick++)
+        {
+            double value = m_x_ticks.GetValue(tick);
+            int x = rect.x + left_pad + (int)((value - start_x) * width / x_range);
+            const wxTrendPlotTickLabel& label = MeasureLabel(dc, m_x_ticks, value);
+            
+            dc->DrawText(label.label,
+                         x - (int)(label.width / 2),
+                         rect.y + rect.height - (bottom_pad/2) - 10);
+            
+            dc->DrawLine(x, rect.y + top_pad + height - 1,
+                         x, rect.y + top_pad + height + 5);
+        }
         
-        // Draw the grid lines for the graph
-        cairo_set_source_rgb (cairo_image, 0xE0/256.0,
-                                  0xE0/256.0,
-                                  0xE0/256.0);
-        for(int count = 1; count < number_x_data_points; count++)
+        for(size_t tick = 0; tick < m_y_ticks.GetCount(); tick++)
+        {
+            double value = m_y_ticks.GetValue(tick);
+            int y = rect.y + top_pad + height - (int)((value - m_y_min) * height / y_range);
+            const wxTrendPlotTickLabel& label = MeasureLabel(dc, m_y_ticks, value);
+            
+            dc->DrawLine(rect.x + left_pad - 4, y,
+                         rect.x + left_pad, y);
+            
+            dc->DrawText(label.label,
+                         rect.x + left_pad - 6 - (int)label.width,
+                         y - (int)(label.height / 2));
+        }
+        
+        font.SetFamily(wxFONTFAMILY_ROMAN);
+        font.SetPointSize(10);
+        font.SetWeight(wxBOLD);
+        dc->SetFont(font);
+        
+        if(m_show_title)
+        {
+            dc->DrawText(m_title, rect.width/2, rect.y + 10);
+        }
+        
+        font.SetFamily(wxFONTFAMILY_ROMAN);
+        font.SetPointSize(8);
+        dc->SetFont(font);
+        
+        if(m_show_x_axis_title)
+        {
+            dc->DrawText(m_x_axis_title, rect.width/2, rect.y + rect.height - 16);
+        }
+        
+        if(m_show_y_axis_title)
+        {
+            dc->DrawRotatedText(m_y_axis_title, rect.x + 2, rect.y + rect.height/2, 90);
+        }
+        
+        dc->SetTextForeground(wxColour(0xA0, 0xA0, 0xA0));
+        
+        if(m_is_paused)
         {
-            cairo_move_to (cairo_image,
-                           rect.x + left_pad + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)),
-                           rect.y + top_pad + 1);
-            cairo_line_to (cairo_image,
-                           rect.x + left_pad + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)),
-                           rect.y + top_pad - 1 + rect.height - top_pad - bottom_pad - 1);
-        
-            cairo_stroke (cairo_image);
+            pen.SetColour(0xA0, 0xA0, 0xA0);
+            dc->SetPen(pen);
+            dc->DrawText(wxT("Paused"), rect.width - 80, rect.y + 5);
         }
         
-        for(int count = 1; count <= number_y_data_points; count++)
+        if(m_zoom_factor != 1.0)
         {
-            cairo_move_to (cairo_image,
-                           rect.x + left_pad + 1,
-                           rect.y + top_pad + (1.0 * count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points))));
-            cairo_line_to (cairo_image,
-                           rect.x + rect.width - right_pad - 2,
-                           rect.y + top_pad + (1.0 * count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points))));
-            cairo_stroke (cairo_image);
+            dc->DrawText(wxString::Format(wxT("Zoom: %.1f%%"), m_zoom_factor * 100), rect.width - 80, rect.y + 15);
         }
         
-        int min_x = rect.x + left_pad;
-        int max_x = rect.x - right_pad + rect.width;
-        int min_y = rect.y + rect.height - bottom_pad;
-        int max_y = rect.y + top_pad;
-        
-        map<double, double>::iterator iter;
-        
-        double x_increment = x_range / (max_x - min_x);
-        double y_increment = -(y_range / (max_y - min_y));
         
-        for(size_t index = 0; index < m_data_sets.size(); index++)
+        // Now draw the legend
+        if(m_show_legend)
         {
-            cairo_set_source_rgb (cairo_image,
-                                  m_data_sets[index].m_color.Red()/256.0,
-                                  m_data_sets[index].m_color.Green()/256.0,
-                                  m_data_sets[index].m_color.Blue()/256.0);
-        
-            if(m_data_sets[index].m_points.size() != 0)
+            int x = rect.x + rect.width - right_pad + 10;
+            int y = 50;
+            
+            dc->SetBrush(wxColour(0xE0, 0xE0, 0xE0));
+            dc->DrawRectangle(rect.x + rect.width - right_pad + 5, y, right_pad - 8, 18);
+            dc->SetTextForeground(wxColour(0x0, 0x0, 0x0));
+            dc->DrawText(wxT("Legend:"), x, y);
+            
+            dc->SetTextForeground(wxColour(0xA0, 0xA0, 0xA0));
+            int save_y = y;
+            int height = 0;
+            y += 17;
+            for(size_t index = 0; index < m_data_sets.GetCount(); index++)
             {
-                int prev_x = min_x + (m_data_sets[index].m_points.begin()->first - start_x)/x_increment;
-                int prev_y = min_y - (m_data_sets[index].m_points.begin()->second / y_increment);
-                
-                iter = m_data_sets[index].m_points.begin();
-        
-                // Find the first point that is less than the start point. That
-                // will become our prev_x and prev_y
-                for(; iter != m_data_sets[index].m_points.end(); iter++)
-                {
-                    if(iter->first <= start_x)
-                    {
-                        prev_x = min_x + ((iter->first - start_x) / x_increment);
-                        prev_y = min_y - (iter->second / y_increment);
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
-
-                if(iter != m_data_sets[index].m_points.end())
-                {
-                    iter++;
-                }
+                y += 18;
+                height += 18;
+            }
+            dc->SetBrush(wxColour(0xF0, 0xF0, 0xF0));
+            dc->DrawRectangle(rect.x + rect.width - right_pad + 5, y-height,
+                             right_pad - 8, height + 2);
+                             
+            y = save_y;
+            y += 20;
+            
+            for(size_t slot = m_data_sets.GetFirst();
+                slot != TREND_PLOT_INVALID_SLOT;
+                slot = m_data_sets.GetNext(slot))
+            {
+                dc->SetBrush(m_data_sets.Get(slot).m_color);
                 
-                for(; iter != m_data_sets[index].m_points.end(); iter++)
-                {
-                    // If the point is out of bounds then don't plot it
-                    if(iter->first > start_x + m_x_axis_width)
-                    {
-                        break;
-                    }
-        
-                    int x = min_x + ((iter->first - start_x) / x_increment);
-                    int y = min_y - (iter->second / y_increment);
-                    
-                    cairo_move_to (cairo_image,
-                                   prev_x,
-                                   prev_y);
-                    cairo_line_to (cairo_image,
-                                   x,
-                                   y);
-                    cairo_stroke (cairo_image);
-                    prev_x = x;
-                    prev_y = y;
-                }
+                dc->DrawRectangle(x, y, 15, 15);
+                dc->DrawText(m_data_sets.Get(slot).m_label, x + 18, y);
+                y += 18;
+                height += 18;
             }
         }
-       
-        // Over-write the right hand side of the graph
-        cairo_set_source_rgb (cairo_image,
-                              1, 1, 1);
-        cairo_rectangle(cairo_image,
-                        rect.width - right_pad,
-                        0,
-                        rect.width,
-                        rect.height);
-        cairo_fill(cairo_image);
-        
-        
-        // Over-write the left hand side of the graph
-        cairo_rectangle(cairo_image,
-                        0,
-                        0,
-                        left_pad,
-                        rect.height);
-        cairo_fill(cairo_image);
-        
-        // Over-write the top part of the graph
-        cairo_rectangle(cairo_image,
-                        rect.x,
-                        rect.y,
-                        rect.x + rect.width,
-                        rect.y + top_pad);
-        cairo_fill(cairo_image);
-        
-        // Over-write the bottom part of the graph
-        cairo_rectangle(cairo_image,
-                        rect.x,
-                        rect.y + rect.height - bottom_pad,
-                        rect.x + rect.width,
-                        rect.y + rect.height);
-        cairo_fill(cairo_image);
-       
-        // Now draw the labels
-        cairo_select_font_face(cairo_image, "Times",
-                               CAIRO_FONT_SLANT_NORMAL,
-                               CAIRO_FONT_WEIGHT_NORMAL);
-        cairo_set_font_size (cairo_image, 11);
+    } // end of if(m_antialiasing)
 
-        for(int count = 0; count <= number_x_data_points; count++)
-        {
-            double x = (x_range/number_x_data_points) * count; 
-            cairo_move_to(cairo_image,
-                          rect.x + left_pad - 8 + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)),
-                          rect.y + rect.height - (bottom_pad/2));
-            cairo_set_source_rgb (cairo_image,
-                              0, 0, 0);
-            cairo_show_text (cairo_image, wxString::Format(wxT("%2.2f"), start_x + x).char_str());
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    BuildScene()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context the plot is being drawn with.
+//|    rect        (I) - The client area of the plot.
+//|    start_x     (I) - The x value at the left hand side of the plot.
+//|    lines       (I) - Set to add the line of each data set.
+//|
+//| FUNCTION:
+//|    This method works out everything needed to draw a frame with cairo
+//|    and stores it in m_scene: the y axis is scaled, the static parts of
+//|    the plot are brought up to date, the ticks along the x axis are
+//|    placed and measured and each data set is reduced to the points that
+//|    are on screen. This is the only part of drawing a frame that reads
+//|    the data sets, so the scene can then be drawn on another thread.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::BuildScene(cairo_t*      cairo_image,
+                             const wxRect& rect,
+                             double        start_x,
+                             bool          lines)
+{
+    AutoScale(start_x);
+    
+    // Make sure the static parts of the plot are up to date. This
+    // also works out the padding around the plot.
+    UpdateChrome(cairo_image, rect);
+    
+    int bottom_pad = m_bottom_pad;
+    int top_pad    = m_top_pad;
+    int left_pad   = m_left_pad;
+    int right_pad  = m_right_pad;
+    double x_range = m_x_axis_width;
+    double y_range = m_y_max - m_y_min;
+    
+    int min_x = rect.x + left_pad;
+    int max_x = rect.x - right_pad + rect.width;
+    int min_y = rect.y + rect.height - bottom_pad;
+    int max_y = rect.y + top_pad;
+    
+    double x_increment = x_range / (max_x - min_x);
+    double y_increment = -(y_range / (max_y - min_y));
+    
+    m_scene.Begin(rect,
+                  m_chrome,
+                  wxRect(min_x, max_y, max_x - min_x, min_y - max_y),
+                  m_clip);
+    m_scene.SetLabelY(rect.y + rect.height - (bottom_pad/2));
+    
+    // The ticks along the x axis move as the plot scrolls so they
+    // can't be cached with the rest, but the text of each label and
+    // its size are kept while it is on screen.
+    m_x_ticks.Update(start_x,
+                     start_x + x_range,
+                     max_x - min_x,
+                     TREND_PLOT_X_TICK_SPACING);
+    
+    cairo_select_font_face(cairo_image, "Times",
+                           CAIRO_FONT_SLANT_NORMAL,
+                           CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cairo_image, 11);
+    
+    for(size_t tick = 0; tick < m_x_ticks.GetCount(); tick++)
+    {
+        double value = m_x_ticks.GetValue(tick);
+        const wxTrendPlotTickLabel& label = MeasureLabel(cairo_image,
+                                                         m_x_ticks,
+                                                         value);
+        
+        m_scene.AddTick(min_x + ((value - start_x) / x_increment),
+                        label.width,
+                        label.text);
+    }
+    
+    if(lines)
+    {
+        ResetScreenX();
         
-            cairo_set_source_rgb (cairo_image,
-                              0xA0/256.0, 0xA0/256.0, 0xA0/256.0);
-            cairo_move_to(cairo_image, rect.x + left_pad + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)), 
-                        rect.y + top_pad - 1 + rect.height - top_pad - bottom_pad);
-            cairo_line_to(cairo_image,
-                        rect.x + left_pad + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)),
-                        rect.y + top_pad + 5 + rect.height - top_pad - bottom_pad);
-            cairo_stroke(cairo_image);
+        for(size_t slot = m_data_sets.GetFirst();
+            slot != TREND_PLOT_INVALID_SLOT;
+            slot = m_data_sets.GetNext(slot))
+        {
+            const wxTrendPlotDataset& data = m_data_sets.Get(slot);
+            
+            const vector<wxPoint>& points = DecimateDataSet(data,
+                                                            start_x,
+                                                            min_x,
+                                                            max_x,
+                                                            min_y,
+                                                            x_increment,
+                                                            y_increment,
+                                                            true);
+            
+            m_scene.AddLine(data.m_color.Red()/256.0,
+                            data.m_color.Green()/256.0,
+                            data.m_color.Blue()/256.0,
+                            points);
         }
+    }
+    
+    // The label is formatted here so the render thread only has
+    // to show it.
+    std::string zoom;
+    
+    if(m_zoom_factor != 1.0)
+    {
+        zoom = wxString::Format(wxT("Zoom: %.1f%%"), m_zoom_factor * 100).mb_str();
+    }
+    
+    m_scene.SetStatus(m_is_paused, zoom);
+}
 
-        for(int count = 0; count < number_y_data_points; count++)
-        {
-            double y = y_range - ((y_range/number_y_data_points) * count);
-            cairo_move_to(cairo_image,
-                          rect.x + left_pad - 30,
-                          rect.y + top_pad + 2 + count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points)));
-            cairo_set_source_rgb (cairo_image,
-                              0, 0, 0);
-            cairo_show_text (cairo_image, wxString::Format(wxT("%2.2f"), y).char_str());
 
-            cairo_move_to(cairo_image,
-                          rect.x + left_pad - 4, 
-                          rect.y + top_pad + count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points)));
-            cairo_line_to(cairo_image,
-                          rect.x + left_pad, 
-                          rect.y + top_pad + count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points)));
-            cairo_stroke(cairo_image);
-        }
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    UpdateChrome()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context the plot is being drawn with.
+//|    rect        (I) - The client area of the plot.
+//|
+//| FUNCTION:
+//|    This method makes sure the cached copy of the static parts of the
+//|    plot is up to date. It is only redrawn if it has been invalidated
+//|    or the size of the plot has changed. The cache is created to be
+//|    similar to the surface being drawn on so that copying it to the
+//|    screen is as cheap as possible.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::UpdateChrome(cairo_t* cairo_image, const wxRect& rect)
+{
+    if(m_chrome != NULL &&
+       (m_chrome_width != rect.width || m_chrome_height != rect.height))
+    {
+        DestroyChrome();
+    }
+
+    // A scene waiting for the render thread may still be drawing from
+    // the old copy, so a new one is created rather than drawing over it.
+    if(m_chrome != NULL &&
+       !m_chrome_valid &&
+       cairo_surface_get_reference_count(m_chrome) > 1)
+    {
+        DestroyChrome();
+    }
+
+    if(m_chrome == NULL)
+    {
+        m_chrome = cairo_surface_create_similar(cairo_get_target(cairo_image),
+                                                CAIRO_CONTENT_COLOR,
+                                                rect.width,
+                                                rect.height);
+        m_chrome_width = rect.width;
+        m_chrome_height = rect.height;
+        m_chrome_valid = false;
+    }
+
+    if(m_chrome_valid)
+    {
+        return;
+    }
+
+    cairo_t* chrome = cairo_create(m_chrome);
+    DrawChrome(chrome, rect);
+    cairo_destroy(chrome);
+
+    m_chrome_valid = true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DestroyChrome()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method releases the cached copy of the static parts of the
+//|    plot. It is re-created the next time the plot is drawn.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::DestroyChrome(void)
+{
+    if(m_chrome != NULL)
+    {
+        cairo_surface_destroy(m_chrome);
+        m_chrome = NULL;
+    }
+
+    m_chrome_valid = false;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    MeasureLabel()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to measure the label with.
+//|    ticks       (I) - The ticks of the axis the label belongs to.
+//|    value       (I) - The value of the tick.
+//|
+//| FUNCTION:
+//|    This method looks up the label of a tick. The first time it is used
+//|    it is measured in the font selected in the cairo context, which must
+//|    always be the same font when the label is drawn.
+//|
+//| RETURNS:
+//|    The label of the tick.
+//|
+//+------------------------------------------------------------------------------
+const wxTrendPlotTickLabel& wxTrendPlot::MeasureLabel(cairo_t*          cairo_image,
+                                                      wxTrendPlotTicks& ticks,
+                                                      double            value)
+{
+    wxTrendPlotTickLabel& label = ticks.GetLabel(value, TREND_PLOT_CAIRO_LABEL_FONT);
+
+    if(!label.measured)
+    {
+        cairo_text_extents_t extents;
+
+        cairo_text_extents(cairo_image, label.text.c_str(), &extents);
+
+        label.width = extents.x_advance;
+        label.height = extents.height;
+        label.measured = true;
+    }
+
+    return label;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    MeasureLabel()
+//|
+//| PARAMETERS:
+//|    dc    (I) - The device context to measure the label with.
+//|    ticks (I) - The ticks of the axis the label belongs to.
+//|    value (I) - The value of the tick.
+//|
+//| FUNCTION:
+//|    This method looks up the label of a tick, measuring it in the font
+//|    selected in the device context the first time it is used.
+//|
+//| RETURNS:
+//|    The label of the tick.
+//|
+//+------------------------------------------------------------------------------
+const wxTrendPlotTickLabel& wxTrendPlot::MeasureLabel(wxDC*             dc,
+                                                      wxTrendPlotTicks& ticks,
+                                                      double            value)
+{
+    wxTrendPlotTickLabel& label = ticks.GetLabel(value, TREND_PLOT_DC_LABEL_FONT);
+
+    if(!label.measured)
+    {
+        wxCoord width;
+        wxCoord height;
+
+        dc->GetTextExtent(label.label, &width, &height);
+
+        label.width = width;
+        label.height = height;
+        label.measured = true;
+    }
+
+    return label;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrawChrome()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to draw with.
+//|    rect        (I) - The client area of the plot.
+//|
+//| FUNCTION:
+//|    This method draws the parts of the plot that don't change from one
+//|    frame to the next: the background, border, the grid lines across the
+//|    y axis, the y axis ticks and labels, titles and legend. The x axis
+//|    ticks scroll with the data so they are drawn with each frame. The
+//|    padding around the graph is worked out here as it depends on the
+//|    size of the legend and the y axis labels.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::DrawChrome(cairo_t* cairo_image, const wxRect& rect)
+{
+    int bottom_pad = 50;
+    int top_pad    = 40;
+    int left_pad   = 60;
+    int right_pad  = 20;
+    double y_range = m_y_max - m_y_min;
+
+    // Clear the background and set it to white
+    cairo_set_source_rgb (cairo_image, 1, 1, 1);
+    cairo_rectangle(cairo_image, 0, 0, rect.width, rect.height);
+    cairo_fill(cairo_image);
+    
+    if(!m_show_title)
+    {
+        top_pad = 10;
+    }
+    
+    if(!m_show_x_axis_title)
+    {
+        bottom_pad = 45;
+    }
 
+    if(!m_show_y_axis_title)
+    {
+        left_pad = 45;
+        right_pad = 45;
+    }
+    
+    // If the legend is enabled then calculate the space we require
+    // on the right hand side of the graph
+    if(m_show_legend)
+    {
+        int text_extent = 0;
+        cairo_text_extents_t extents;
+        
         cairo_select_font_face(cairo_image, "Times",
                                CAIRO_FONT_SLANT_NORMAL,
-                               CAIRO_FONT_WEIGHT_BOLD);
-        cairo_set_font_size (cairo_image, 12);
+                               CAIRO_FONT_WEIGHT_NORMAL);
+        cairo_set_font_size (cairo_image, 8 + 2);
         
-        if(m_show_title)
+        cairo_text_extents (cairo_image, "Legend:", &extents);
+            
+        if(extents.width > text_extent)
         {
-            cairo_text_extents_t extents;
+            text_extent = extents.width;
+        }
             
-            // Get the width of the title. We need to do this
-            // so that we can subtract half the width in order
-            // to center it.
+        for(size_t slot = m_data_sets.GetFirst();
+            slot != TREND_PLOT_INVALID_SLOT;
+            slot = m_data_sets.GetNext(slot))
+        {
             cairo_text_extents (cairo_image,
-                                m_title.char_str(),
+                                m_data_sets.Get(slot).m_label.char_str(),
                                 &extents);  
-
-            cairo_move_to(cairo_image,
-                          rect.width/2 - extents.width/2,
-                          rect.y + 21);
-            cairo_show_text(cairo_image, m_title.char_str());
+            
+            if(extents.width > text_extent)
+            {
+                text_extent = extents.width;
+            }
         }
-       
-        cairo_set_font_size (cairo_image, 8 + 2);
         
-        cairo_set_source_rgb (cairo_image,
-                              0xA0/256.0,0xA0/256.0, 0xA0/256.0);
-        if(m_is_paused)
-        {
-            cairo_move_to(cairo_image, rect.width - 80, rect.y + 15);
-            cairo_show_text(cairo_image, "Paused");
-        }
+        right_pad = text_extent + 50;
+    }
+    
+    // Place the ticks along the y axis and make room for the
+    // widest of their labels.
+    int height = rect.height - top_pad - bottom_pad;
+    
+    m_y_ticks.Update(m_y_min, m_y_max, height, TREND_PLOT_Y_TICK_SPACING);
+    
+    cairo_select_font_face(cairo_image, "Times",
+                           CAIRO_FONT_SLANT_NORMAL,
+                           CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cairo_image, 11);
+    
+    for(size_t tick = 0; tick < m_y_ticks.GetCount(); tick++)
+    {
+        const wxTrendPlotTickLabel& label = MeasureLabel(cairo_image,
+                                                         m_y_ticks,
+                                                         m_y_ticks.GetValue(tick));
+        int width = (int)ceil(label.width) + 10;
         
-        if(m_zoom_factor != 1.0)
+        if(m_show_y_axis_title)
         {
-            printf("Zoom factor: %f\n", m_zoom_factor);
-
-            cairo_move_to(cairo_image, rect.width - 80, rect.y + 25);
-            cairo_show_text(cairo_image, wxString::Format(wxT("Zoom: %.1f%%"), m_zoom_factor * 100).char_str());
-            cairo_stroke(cairo_image);
+            width += 20;
         }
         
-        cairo_set_source_rgb (cairo_image,
-                              0,0, 0);
-        if(m_show_x_axis_title)
+        if(width > left_pad)
         {
-            cairo_move_to(cairo_image,rect.width/2, rect.y + rect.height - 8); 
-            cairo_show_text(cairo_image, m_x_axis_title.char_str());
+            left_pad = width;
         }
+    }
+    
+    m_bottom_pad = bottom_pad;
+    m_top_pad = top_pad;
+    m_left_pad = left_pad;
+    m_right_pad = right_pad;
+    
+    // Draw a black border around the graph
+    cairo_set_line_width(cairo_image, 0.7);
+    cairo_set_source_rgb (cairo_image, 0, 0, 0);
+    cairo_rectangle(cairo_image,
+                    rect.x + left_pad,
+                    rect.y + top_pad,
+                    rect.width - left_pad - right_pad,
+                    height);
+    cairo_stroke (cairo_image);
+    
+    // Draw the grid lines across the graph. The ones along the
+    // x axis scroll with the plot so they are drawn each frame.
+    cairo_set_source_rgb (cairo_image, 0xE0/256.0,
+                              0xE0/256.0,
+                              0xE0/256.0);
+    for(size_t tick = 0; tick < m_y_ticks.GetCount(); tick++)
+    {
+        double y = rect.y + top_pad + height - ((m_y_ticks.GetValue(tick) - m_y_min) * height / y_range);
         
-        if(m_show_y_axis_title)
+        if(y > rect.y + top_pad + 1 && y < rect.y + top_pad + height - 1)
         {
-            cairo_move_to(cairo_image, rect.x + 15, rect.y + rect.height/2);
-            cairo_save(cairo_image);
-            cairo_rotate(cairo_image, -90/57.2957795);
-            cairo_show_text(cairo_image, m_y_axis_title.char_str());
-            cairo_restore(cairo_image);
+            cairo_move_to (cairo_image, rect.x + left_pad + 1, y);
+            cairo_line_to (cairo_image, rect.x + rect.width - right_pad - 2, y);
         }
+    }
+    cairo_stroke (cairo_image);
+
+    // and the labels and tick marks along the y axis
+    cairo_set_source_rgb (cairo_image,
+                      0, 0, 0);
+
+    for(size_t tick = 0; tick < m_y_ticks.GetCount(); tick++)
+    {
+        double value = m_y_ticks.GetValue(tick);
+        double y = rect.y + top_pad + height - ((value - m_y_min) * height / y_range);
+        const wxTrendPlotTickLabel& label = MeasureLabel(cairo_image, m_y_ticks, value);
+        
+        cairo_move_to(cairo_image,
+                      rect.x + left_pad - 6 - label.width,
+                      y + (label.height / 2));
+        cairo_show_text (cairo_image, label.text.c_str());
+
+        cairo_move_to(cairo_image,
+                      rect.x + left_pad - 4, 
+                      y);
+        cairo_line_to(cairo_image,
+                      rect.x + left_pad, 
+                      y);
+        cairo_stroke(cairo_image);
+    }
+
+    cairo_select_font_face(cairo_image, "Times",
+                           CAIRO_FONT_SLANT_NORMAL,
+                           CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size (cairo_image, 12);
+    
+    if(m_show_title)
+    {
+        cairo_text_extents_t extents;
+        
+        // Get the width of the title. We need to do this
+        // so that we can subtract half the width in order
+        // to center it.
+        cairo_text_extents (cairo_image,
+                            m_title.char_str(),
+                            &extents);  
+
+        cairo_move_to(cairo_image,
+                      rect.width/2 - extents.width/2,
+                      rect.y + 21);
+        cairo_show_text(cairo_image, m_title.char_str());
+    }
+   
+    cairo_set_font_size (cairo_image, 8 + 2);
+    
+    cairo_set_source_rgb (cairo_image,
+                          0,0, 0);
+    if(m_show_x_axis_title)
+    {
+        cairo_move_to(cairo_image,rect.width/2, rect.y + rect.height - 8); 
+        cairo_show_text(cairo_image, m_x_axis_title.char_str());
+    }
+    
+    if(m_show_y_axis_title)
+    {
+        cairo_move_to(cairo_image, rect.x + 15, rect.y + rect.height/2);
+        cairo_save(cairo_image);
+        cairo_rotate(cairo_image, -90/57.2957795);
+        cairo_show_text(cairo_image, m_y_axis_title.char_str());
+        cairo_restore(cairo_image);
+    }
+    
+    // Now draw the legend
+    if(m_show_legend)
+    {
+        int x = rect.x + rect.width - right_pad + 10;
+        int y = 50;
+        
+        // Fill in the legend title
+        cairo_set_source_rgb (cairo_image,
+                              0xe0/256.0,0xe0/256.0, 0xe0/256.0);
+        cairo_rectangle(cairo_image,
+                        rect.x + rect.width - right_pad + 5, y, right_pad - 8, 18);
+        cairo_fill(cairo_image);
         
+        // Create a border around the legend title
         cairo_set_source_rgb (cairo_image,
-                              0,0, 0);
+                          0xa0/256.0,0xa0/256.0, 0xa0/256.0);
+        cairo_rectangle(cairo_image,
+                        rect.x + rect.width - right_pad + 5, y, right_pad - 8, 18);
+        cairo_stroke(cairo_image);
         
         
-        // Now draw the legend
-        if(m_show_legend)
+        cairo_set_source_rgb (cairo_image,
+                         0,0,0);
+        cairo_stroke(cairo_image);
+    
+        cairo_move_to(cairo_image, x, y + 12);
+        cairo_show_text(cairo_image, "Legend:");
+        cairo_stroke(cairo_image);
+    
+        int save_y = y;
+        int height = 0;
+        y += 17;
+        for(size_t index = 0; index < m_data_sets.GetCount(); index++)
         {
-            int x = rect.x + rect.width - right_pad + 10;
-            int y = 50;
-            
-            // Fill in the legend title
-            cairo_set_source_rgb (cairo_image,
-                                  0xe0/256.0,0xe0/256.0, 0xe0/256.0);
-            cairo_rectangle(cairo_image,
-                            rect.x + rect.width - right_pad + 5, y, right_pad - 8, 18);
-            cairo_fill(cairo_image);
-            
-            // Create a border around the legend title
-            cairo_set_source_rgb (cairo_image,
-                              0xa0/256.0,0xa0/256.0, 0xa0/256.0);
-            cairo_rectangle(cairo_image,
-                            rect.x + rect.width - right_pad + 5, y, right_pad - 8, 18);
-            cairo_stroke(cairo_image);
-            
-            
-            cairo_set_source_rgb (cairo_image,
-                             0,0,0);
-            cairo_stroke(cairo_image);
+            y += 18;
+            height += 18;
+        }
+    
+        cairo_set_source_rgb (cairo_image,
+                              0xf0/256.0,0xf0/256.0, 0xf0/256.0);
+        cairo_rectangle(cairo_image,
+                        rect.x + rect.width - right_pad + 5, y-height,
+                         right_pad - 8, height + 2);
+        cairo_fill(cairo_image);
         
-            cairo_move_to(cairo_image, x, y + 12);
-            cairo_show_text(cairo_image, "Legend:");
-            cairo_stroke(cairo_image);
+        cairo_set_source_rgb (cairo_image,
+                          0xa0/256.0,0xa0/256.0, 0xa0/256.0);
+        cairo_rectangle(cairo_image,
+                        rect.x + rect.width - right_pad + 5, y-height,
+                         right_pad - 8, height + 2);
+        cairo_stroke(cairo_image);
         
-            int save_y = y;
-            int height = 0;
-            y += 17;
-            for(size_t index = 0; index < m_data_sets.size(); index++)
-            {
-                y += 18;
-                height += 18;
-            }
         
+        y = save_y;
+        y += 20;
+        
+        for(size_t slot = m_data_sets.GetFirst();
+            slot != TREND_PLOT_INVALID_SLOT;
+            slot = m_data_sets.GetNext(slot))
+        {
             cairo_set_source_rgb (cairo_image,
-                                  0xf0/256.0,0xf0/256.0, 0xf0/256.0);
+                                  m_data_sets.Get(slot).m_color.Red()/256.0,
+                                  m_data_sets.Get(slot).m_color.Green()/256.0,
+                                  m_data_sets.Get(slot).m_color.Blue()/256.0);
             cairo_rectangle(cairo_image,
-                            rect.x + rect.width - right_pad + 5, y-height,
-                             right_pad - 8, height + 2);
+                        x, y, 15, 15);
             cairo_fill(cairo_image);
-            
-            cairo_set_source_rgb (cairo_image,
-                              0xa0/256.0,0xa0/256.0, 0xa0/256.0);
-            cairo_rectangle(cairo_image,
-                            rect.x + rect.width - right_pad + 5, y-height,
-                             right_pad - 8, height + 2);
-            cairo_stroke(cairo_image);
-            
-            
-            y = save_y;
-            y += 20;
-            
-            for(size_t index = 0; index < m_data_sets.size(); index++)
-            {
-                cairo_set_source_rgb (cairo_image,
-                                      m_data_sets[index].m_color.Red()/256.0,
-                                      m_data_sets[index].m_color.Green()/256.0,
-                                      m_data_sets[index].m_color.Blue()/256.0);
-                cairo_rectangle(cairo_image,
-                            x, y, 15, 15);
-                cairo_fill(cairo_image);
-                cairo_move_to(cairo_image,x+18,y+12);
-                cairo_show_text(cairo_image, m_data_sets[index].m_label.char_str());
-                y += 18;
-                height += 18;
-            }
+            cairo_move_to(cairo_image,x+18,y+12);
+            cairo_show_text(cairo_image, m_data_sets.Get(slot).m_label.char_str());
+            y += 18;
+            height += 18;
         }
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    StrokeDataSets()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to draw with.
+//|    start_x     (I) - The x value at min_x.
+//|    min_x       (I) - The left hand side of the area to draw in pixels.
+//|    max_x       (I) - The right hand side of the area to draw in pixels.
+//|    min_y       (I) - The bottom of the graph in pixels.
+//|    x_increment (I) - The x units per pixel.
+//|    y_increment (I) - The y units per pixel.
+//|    visible     (I) - Lines entirely outside of this area aren't drawn.
+//|    summarise   (I) - Set to allow the pyramid of each data set to be
+//|                      used when there are many points per pixel.
+//|
+//| FUNCTION:
+//|    This method draws the line of each data set with cairo. It is used
+//|    to draw the columns of a strip chart.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::StrokeDataSets(cairo_t*      cairo_image,
+                                 double        start_x,
+                                 int           min_x,
+                                 int           max_x,
+                                 int           min_y,
+                                 double        x_increment,
+                                 double        y_increment,
+                                 const wxRect& visible,
+                                 bool          summarise)
+{
+    cairo_set_line_width(cairo_image, 0.7);
+    ResetScreenX();
+    
+    for(size_t slot = m_data_sets.GetFirst();
+        slot != TREND_PLOT_INVALID_SLOT;
+        slot = m_data_sets.GetNext(slot))
+    {
+        const wxTrendPlotDataset& data = m_data_sets.Get(slot);
+        
+        cairo_set_source_rgb (cairo_image,
+                              data.m_color.Red()/256.0,
+                              data.m_color.Green()/256.0,
+                              data.m_color.Blue()/256.0);
+    
+        const vector<wxPoint>& points = DecimateDataSet(data,
+                                                        start_x,
+                                                        min_x,
+                                                        max_x,
+                                                        min_y,
+                                                        x_increment,
+                                                        y_increment,
+                                                        summarise);
+        
+        wxTrendPlotScene::StrokeLine(cairo_image, points, visible);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrawStrip()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to draw with.
+//|    start_x     (I) - The x value at the left hand side of the graph.
+//|    min_x       (I) - The left hand side of the graph in pixels.
+//|    max_x       (I) - The right hand side of the graph in pixels.
+//|    min_y       (I) - The bottom of the graph in pixels.
+//|    max_y       (I) - The top of the graph in pixels.
+//|    x_increment (I) - The x units per pixel.
+//|    y_increment (I) - The y units per pixel.
+//|
+//| FUNCTION:
+//|    This method draws the lines when the plot is a strip chart. Only
+//|    the columns of the ring that have come into view or have had
+//|    points added to them since the last frame are drawn. The ring is
+//|    then copied onto the graph.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::DrawStrip(cairo_t* cairo_image,
+                            double   start_x,
+                            int      min_x,
+                            int      max_x,
+                            int      min_y,
+                            int      max_y,
+                            double   x_increment,
+                            double   y_increment)
+{
+    if(!m_strip.Setup(cairo_image, max_x - min_x, min_y - max_y, x_increment))
+    {
         return;
     }
-    else
+    
+    wxInt64 start_column = m_strip.GetColumn(start_x);
+    wxInt64 first;
+    wxInt64 last;
+    
+    if(m_strip.FindDirtyColumns(start_column, first, last))
     {
-        wxDC* dc = (wxDC*)drawer;
+        // Draw the columns in runs that don't wrap around the
+        // end of the ring.
+        wxInt64 column = first;
         
-        // If the start point wasn't overridden then use the stored
-        // start point for this plot
-        if(start_x == 0)
+        while(column < last)
         {
-            if(m_is_paused)
-            {
-                start_x = m_pause_point;
-            }
-            else
+            int offset = m_strip.GetOffset(column);
+            wxInt64 end = column + (m_strip.GetWidth() - offset);
+            
+            if(end > last)
             {
-                start_x = m_start_plot_x;
+                end = last;
             }
-        }
-        
-        int bottom_pad = 50;
-        int top_pad    = 40;
-        int left_pad   = 50;
-        int right_pad  = 20;
-        int number_x_data_points = 20;
-        int number_y_data_points = 20;
-        double x_range = m_x_axis_width;
-        double y_range = 5.0;
-        wxPen pen;
-        wxFont font;
-        
-        if(!m_show_title)
-        {
-            top_pad = 10;
-        }
-        
-        if(!m_show_x_axis_title)
-        {
-            bottom_pad = 25;
-        }
-        
-        if(!m_show_y_axis_title)
-        {
-            left_pad = 45;
-        }
-        
-        if(m_show_legend)
-        {
-            font.SetFamily(wxFONTFAMILY_ROMAN);
-            font.SetPointSize(8);
-            dc->SetFont(font);
             
-            int text_extent = 0;
-            wxCoord width;
-            wxCoord height;
+            wxRect visible(offset, 0, (int)(end - column), m_strip.GetHeight());
+            visible.Inflate(1, 1);
             
-            dc->GetTextExtent(wxT("Legend:"),
-                             &width, &height, 0, 0, &font);
-                
-            if(width > text_extent)
-            {
-                text_extent = width;
-            }
-                
-            for(size_t index = 0; index < m_data_sets.size(); index++)
-            {
-                dc->GetTextExtent(m_data_sets[index].m_label,
-                                 &width, &height, 0, 0, &font);
-                
-                if(width > text_extent)
-                {
-                    text_extent = width;
-                }
-            }
+            // The points aren't summarised as only a few columns are
+            // drawn at a time and the pyramid buckets that are still
+            // filling up would leave stale columns behind.
+            cairo_t* strip = m_strip.Begin(column, end);
+            StrokeDataSets(strip,
+                           column * x_increment,
+                           offset,
+                           offset + (int)(end - column),
+                           m_strip.GetHeight(),
+                           x_increment,
+                           y_increment,
+                           visible,
+                           false);
+            m_strip.End();
             
-            right_pad = text_extent + 50;
-        }
-        
-        pen.SetColour(0x0, 0x0, 0x0);
-        dc->SetPen(pen);
-        
-        dc->SetBrush( *wxWHITE_BRUSH);
-        dc->DrawRectangle(
-            rect.x + left_pad,
-            rect.y + top_pad,
-            rect.width - left_pad - right_pad,
-            rect.height - top_pad - bottom_pad );
-        
-        // Draw the grid
-        for(int count = 1; count < number_x_data_points; count++)
-        {
-            pen.SetColour(0xE0, 0xE0, 0xE0);
-            dc->SetPen(pen);
-            dc->DrawLine(rect.x + left_pad + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)), 
-                        rect.y + top_pad + 1,
-                        rect.x + left_pad + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)),
-                        rect.y + top_pad - 1 + rect.height - top_pad - bottom_pad - 1);
-        }
-        for(int count = 1; count <= number_y_data_points; count++)
-        {
-            pen.SetColour(0xE0, 0xE0, 0xE0);
-            dc->SetPen(pen);
-            dc->DrawLine(rect.x + left_pad + 1, 
-                        rect.y + top_pad + (1.0 * count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points))),
-                        rect.x + rect.width - right_pad - 2, 
-                        rect.y + top_pad + (1.0 * count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points))));
+            column = end;
         }
         
-        
-        pen.SetColour(0x0, 0x0, 0xFF);
-        dc->SetPen(pen);
-        
-        int min_x = rect.x + left_pad;
-        int max_x = rect.x - right_pad + rect.width;
-        int min_y = rect.y + rect.height - bottom_pad;
-        int max_y = rect.y + top_pad;
-        
-        map<double, double>::iterator iter;
-        
-        double x_increment = x_range / (max_x - min_x);
-        double y_increment = -(y_range / (max_y - min_y));
-        
-        for(size_t index = 0; index < m_data_sets.size(); index++)
+        m_strip.Validate(first, last);
+    }
+    
+    m_strip.Draw(cairo_image, min_x, max_y, start_column);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DecimateDataSet()
+//|
+//| PARAMETERS:
+//|    data        (I) - The data set to draw.
+//|    start_x     (I) - The x value at the left hand side of the plot.
+//|    min_x       (I) - The left hand side of the plot in pixels.
+//|    max_x       (I) - The right hand side of the plot in pixels.
+//|    min_y       (I) - The bottom of the plot in pixels.
+//|    x_increment (I) - The x units per pixel.
+//|    y_increment (I) - The y units per pixel.
+//|    summarise   (I) - Set to allow the pyramid to be used.
+//|
+//| FUNCTION:
+//|    This method converts the visible part of a data set into screen
+//|    co-ordinates reduced to at most four points per pixel column. When
+//|    there are many points per pixel the points are read from the
+//|    coarsest level of the data set's pyramid that still has at least
+//|    two buckets per pixel so that the cost doesn't depend on the zoom.
+//|    The visible frames and their screen x co-ordinates are kept for
+//|    the next data set of the same frame group until ResetScreenX() is
+//|    called, so the caller must call it before each frame. Any part of
+//|    the file or the archive of the frame group that is visible is
+//|    drawn first.
+//|
+//| RETURNS:
+//|    The points to draw, which is empty if nothing is visible.
+//|
+//+------------------------------------------------------------------------------
+const vector<wxPoint>& wxTrendPlot::DecimateDataSet(const wxTrendPlotDataset& data,
+                                                    double start_x,
+                                                    int    min_x,
+                                                    int    max_x,
+                                                    int    min_y,
+                                                    double x_increment,
+                                                    double y_increment,
+                                                    bool   summarise)
+{
+    double end_x = start_x + ((max_x - min_x) * x_increment);
+    
+    m_decimator.Begin();
+    
+    // Only walk the points that fall inside the visible part
+    // of the plot. The other data sets of the group have the
+    // same points so the search is only done once per group.
+    if(&data.GetGroup() != m_screen_group)
+    {
+        m_screen_group = &data.GetGroup();
+        m_screen_found = data.FindRange(start_x, end_x, m_screen_first, m_screen_last);
+        m_screen_x.clear();
+    }
+    
+    // The points recorded in the file or pushed out into the
+    // archive come before any of the points held.
+    if(data.GetGroup().GetFile() != NULL &&
+       (data.GetCount() == 0 || start_x < data.GetX(0)))
+    {
+        DecimateFile(data, start_x, end_x, min_x, max_x, min_y, x_increment, y_increment, summarise);
+    }
+    else if(data.GetGroup().GetChunkCount() != 0 &&
+            (data.GetCount() == 0 || start_x < data.GetX(0)))
+    {
+        DecimateArchive(data, start_x, end_x, min_x, min_y, x_increment, y_increment, summarise);
+    }
+    
+    if(!m_screen_found)
+    {
+        return m_decimator.End();
+    }
+    
+    size_t first = m_screen_first;
+    size_t last = m_screen_last;
+    
+    int level = -1;
+    if(summarise && max_x > min_x)
+    {
+        level = data.GetPyramid().GetLevel((last - first) / (max_x - min_x) / 2);
+    }
+    
+    size_t first_bucket;
+    size_t last_bucket;
+    
+    if(level < 0 || !data.FindBuckets(level, start_x, end_x, first_bucket, last_bucket))
+    {
+        // Convert the x co-ordinates to the screen once for
+        // all the data sets of the group.
+        if(m_screen_x.empty())
         {
-            pen.SetColour(m_data_sets[index].m_color.Red(),
-                          m_data_sets[index].m_color.Green(),
-                          m_data_sets[index].m_color.Blue());
-            dc->SetPen(pen);
-            if(m_data_sets[index].m_points.size() != 0)
+            m_screen_x.resize(last - first);
+            
+            for(size_t point = first; point < last; point++)
             {
-                int prev_x = min_x + (m_data_sets[index].m_points.begin()->first - start_x)/x_increment;
-                int prev_y = min_y - (m_data_sets[index].m_points.begin()->second / y_increment);
-                
-                iter = m_data_sets[index].m_points.begin();
-                iter++;
-                
-                for(; iter != m_data_sets[index].m_points.end(); iter++)
-                {
-                    
-                    int x = min_x + ((iter->first - start_x) / x_increment);
-                    int y = min_y - (iter->second / y_increment);
-                    dc->DrawLine(prev_x,
-                                prev_y,
-                                x,
-                                y);
-                    prev_x = x;
-                    prev_y = y;
-                }
+                m_screen_x[point - first] = min_x + ((data.GetX(point) - start_x) / x_increment);
             }
         }
         
+        const wxTrendPlotColumn& column = data.GetColumn();
+        const wxTrendPlotEncoding& encoding = column.GetEncoding();
         
-        pen.SetColour(0xFF, 0xFF, 0xFF);
-        dc->SetPen(pen);
-        dc->SetBrush( *wxWHITE_BRUSH);
-        
-        // Over-write the right hand side of the graph
-        dc->DrawRectangle(
-            rect.x + rect.width - right_pad,
-            rect.y,
-            rect.x + rect.width,
-            rect.y + rect.height);
-        
-        // Over-write the left hand side of the graph
-        dc->DrawRectangle(
-            rect.x,
-            rect.y,
-            rect.x + left_pad,
-            rect.y + rect.height);
-        
-        // Over-write the top part of the graph
-        dc->DrawRectangle(
-            rect.x,
-            rect.y,
-            rect.x + rect.width,
-            rect.y + top_pad);
-        
-        // Over-write the bottom part of the graph
-        dc->DrawRectangle(
-            rect.x,
-            rect.y + rect.height - bottom_pad,
-            rect.x + rect.width,
-            rect.y + rect.height);
-        
-        
-        
-        font.SetFamily(wxFONTFAMILY_ROMAN);
-        font.SetPointSize(8);
-        dc->SetFont(font);
-        
-        
-        // Now draw the labels
-        for(int count = 0; count <= number_x_data_points; count++)
-        {
-            double x = (x_range/number_x_data_points) * count; 
-            dc->DrawText(wxString::Format(wxT("%2.2f"), start_x + x),
-                        rect.x + left_pad - 8 + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)),
-                        rect.y + rect.height - (bottom_pad/2) - 10);
-        
-            pen.SetColour(0xA0, 0xA0, 0xA0);
-            dc->SetPen( pen );
-            dc->DrawLine(rect.x + left_pad + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)), 
-                        rect.y + top_pad - 1 + rect.height - top_pad - bottom_pad,
-                        rect.x + left_pad + count * ((rect.width - left_pad - right_pad)/(1.0*number_x_data_points)),
-                        rect.y + top_pad + 5 + rect.height - top_pad - bottom_pad);
-        }
-        
-        for(int count = 0; count < number_y_data_points; count++)
+        switch(encoding.m_type)
         {
-            pen.SetColour(0xA0, 0xA0, 0xA0);
-            dc->SetPen(pen);
-            dc->DrawLine(rect.x + left_pad - 4, 
-                        rect.y + top_pad + count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points)),
-                        rect.x + left_pad, 
-                        rect.y + top_pad + count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points)));
-        
-            double y = y_range - ((y_range/number_y_data_points) * count);
-            dc->DrawText(wxString::Format(wxT("%2.2f"), y),
-                        rect.x + left_pad - 30,
-                        rect.y + top_pad - 8 + count * ((rect.height - top_pad - bottom_pad)/(1.0*number_y_data_points)));
+            case TREND_PLOT_SAMPLE_FLOAT:
+                DecimateSamples(m_decimator, data.GetGroup(), column.GetFloats(), 1.0, -m_y_min,
+                                first, last, m_screen_x, min_y, y_increment);
+                break;
+                
+            case TREND_PLOT_SAMPLE_INT16:
+                DecimateSamples(m_decimator, data.GetGroup(), column.GetInt16s(),
+                                encoding.m_scale, encoding.m_offset - m_y_min,
+                                first, last, m_screen_x, min_y, y_increment);
+                break;
+                
+            default:
+                DecimateSamples(m_decimator, data.GetGroup(), column.GetDoubles(), 1.0, -m_y_min,
+                                first, last, m_screen_x, min_y, y_increment);
+                break;
         }
         
-        font.SetFamily(wxFONTFAMILY_ROMAN);
-        font.SetPointSize(10);
-        font.SetWeight(wxBOLD);
-        dc->SetFont(font);
+        return m_decimator.End();
+    }
+    
+    for(size_t index = first_bucket; index < last_bucket; index++)
+    {
+        AddBucket(data.GetPyramid().GetBucket(level, index),
+                  start_x,
+                  min_x,
+                  min_y,
+                  x_increment,
+                  y_increment);
+    }
+    
+    return m_decimator.End();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddBucket()
+//|
+//| PARAMETERS:
+//|    bucket      (I) - The summary of a run of points.
+//|    start_x     (I) - The x value at the left hand side of the plot.
+//|    min_x       (I) - The left hand side of the plot in pixels.
+//|    min_y       (I) - The bottom of the plot in pixels.
+//|    x_increment (I) - The x units per pixel.
+//|    y_increment (I) - The y units per pixel.
+//|
+//| FUNCTION:
+//|    This method adds the first, minimum, maximum and last points of a
+//|    bucket to the decimator in order of x.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::AddBucket(const wxTrendPlotBucket& bucket,
+                            double                   start_x,
+                            int                      min_x,
+                            int                      min_y,
+                            double                   x_increment,
+                            double                   y_increment)
+{
+    m_decimator.AddPoint(min_x + ((bucket.first_x - start_x) / x_increment),
+                         min_y - ((bucket.first_y - m_y_min) / y_increment));
+    
+    if(bucket.min_x < bucket.max_x)
+    {
+        m_decimator.AddPoint(min_x + ((bucket.min_x - start_x) / x_increment),
+                             min_y - ((bucket.min_y - m_y_min) / y_increment));
+        m_decimator.AddPoint(min_x + ((bucket.max_x - start_x) / x_increment),
+                             min_y - ((bucket.max_y - m_y_min) / y_increment));
+    }
+    else
+    {
+        m_decimator.AddPoint(min_x + ((bucket.max_x - start_x) / x_increment),
+                             min_y - ((bucket.max_y - m_y_min) / y_increment));
+        m_decimator.AddPoint(min_x + ((bucket.min_x - start_x) / x_increment),
+                             min_y - ((bucket.min_y - m_y_min) / y_increment));
+    }
+    
+    m_decimator.AddPoint(min_x + ((bucket.last_x - start_x) / x_increment),
+                         min_y - ((bucket.last_y - m_y_min) / y_increment));
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DecimateArchive()
+//|
+//| PARAMETERS:
+//|    data        (I) - The data set to draw.
+//|    start_x     (I) - The x value at the left hand side of the plot.
+//|    end_x       (I) - The x value at the right hand side of the plot.
+//|    min_x       (I) - The left hand side of the plot in pixels.
+//|    min_y       (I) - The bottom of the plot in pixels.
+//|    x_increment (I) - The x units per pixel.
+//|    y_increment (I) - The y units per pixel.
+//|    summarise   (I) - Set to allow the summaries of the chunks to be
+//|                      used.
+//|
+//| FUNCTION:
+//|    This method adds the archived points of a data set that are visible
+//|    to the decimator. A chunk that fits in a couple of pixel columns is
+//|    drawn from its summary, otherwise it is decoded. The chunks either
+//|    side of the visible range are included so that the lines entering
+//|    and leaving the plot are drawn.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::DecimateArchive(const wxTrendPlotDataset& data,
+                                  double start_x,
+                                  double end_x,
+                                  int    min_x,
+                                  int    min_y,
+                                  double x_increment,
+                                  double y_increment,
+                                  bool   summarise)
+{
+    const wxTrendPlotFrameGroup& group = data.GetGroup();
+    size_t column = group.GetColumnIndex(&data.GetColumn());
+    size_t index = group.FindChunk(start_x);
+    
+    if(index != 0)
+    {
+        index--;
+    }
+    
+    for(; index < group.GetChunkCount(); index++)
+    {
+        const wxTrendPlotChunk& chunk = group.GetChunk(index);
         
-        if(m_show_title)
+        if(summarise && (chunk.GetLastX() - chunk.GetFirstX()) < (2 * x_increment))
         {
-            dc->DrawText(m_title, rect.width/2, rect.y + 10);
+            AddBucket(chunk.GetSummary(column),
+                      start_x,
+                      min_x,
+                      min_y,
+                      x_increment,
+                      y_increment);
         }
-        
-        font.SetFamily(wxFONTFAMILY_ROMAN);
-        font.SetPointSize(8);
-        dc->SetFont(font);
-        
-        if(m_show_x_axis_title)
+        else
         {
-            dc->DrawText(m_x_axis_title, rect.width/2, rect.y + rect.height - 16);
+            const wxTrendPlotDecodedChunk& decoded = DecodeChunk(chunk, column);
+            
+            size_t first = lower_bound(decoded.x.begin(), decoded.x.end(), start_x) - decoded.x.begin();
+            size_t last = upper_bound(decoded.x.begin(), decoded.x.end(), end_x) - decoded.x.begin();
+            
+            if(first != 0)
+            {
+                first--;
+            }
+            
+            if(last != decoded.x.size())
+            {
+                last++;
+            }
+            
+            for(size_t point = first; point < last; point++)
+            {
+                m_decimator.AddPoint(min_x + ((decoded.x[point] - start_x) / x_increment),
+                                     min_y - ((decoded.y[point] - m_y_min) / y_increment));
+            }
         }
         
-        if(m_show_y_axis_title)
+        if(chunk.GetFirstX() > end_x)
         {
-            dc->DrawRotatedText(m_y_axis_title, rect.x + 2, rect.y + rect.height/2, 90);
+            break;
         }
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DecimateFile()
+//|
+//| PARAMETERS:
+//|    data        (I) - The data set to draw.
+//|    start_x     (I) - The x value at the left hand side of the plot.
+//|    end_x       (I) - The x value at the right hand side of the plot.
+//|    min_x       (I) - The left hand side of the plot in pixels.
+//|    max_x       (I) - The right hand side of the plot in pixels.
+//|    min_y       (I) - The bottom of the plot in pixels.
+//|    x_increment (I) - The x units per pixel.
+//|    y_increment (I) - The y units per pixel.
+//|    summarise   (I) - Set to allow the pyramid of the file to be used.
+//|
+//| FUNCTION:
+//|    This method adds the points recorded in the file of a data set that
+//|    are visible and older than the points held to the decimator. Like
+//|    the points held they are read from the coarsest level of the
+//|    pyramid in the file that still has two buckets per pixel, with the
+//|    points after the last closed bucket read directly, so only the
+//|    pages of the file under the visible range are touched.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::DecimateFile(const wxTrendPlotDataset& data,
+                               double start_x,
+                               double end_x,
+                               int    min_x,
+                               int    max_x,
+                               int    min_y,
+                               double x_increment,
+                               double y_increment,
+                               bool   summarise)
+{
+    const wxTrendPlotFile& file = *data.GetGroup().GetFile();
+    size_t column = data.GetGroup().GetColumnIndex(&data.GetColumn());
+    
+    // The points held are drawn from memory, apart from the first
+    // which joins the two up.
+    if(data.GetCount() != 0 && end_x > data.GetX(0))
+    {
+        end_x = data.GetX(0);
+    }
+    
+    size_t first;
+    size_t last;
+    
+    if(!file.FindRange(start_x, end_x, first, last))
+    {
+        return;
+    }
+    
+    size_t point = first;
+    
+    int level = -1;
+    if(summarise && max_x > min_x)
+    {
+        level = file.GetLevel((last - first) / (max_x - min_x) / 2);
+    }
+    
+    if(level >= 0)
+    {
+        size_t size = file.GetBucketSize(level);
         
-        dc->SetTextForeground(wxColour(0xA0, 0xA0, 0xA0));
-        
-        if(m_is_paused)
+        for(size_t index = first / size; index < last / size; index++)
         {
-            pen.SetColour(0xA0, 0xA0, 0xA0);
-            dc->SetPen(pen);
-            dc->DrawText(wxT("Paused"), rect.width - 80, rect.y + 5);
+            AddBucket(file.GetBucket(column, level, index),
+                      start_x,
+                      min_x,
+                      min_y,
+                      x_increment,
+                      y_increment);
+            
+            point = (index + 1) * size;
         }
+    }
+    
+    for(; point < last; point++)
+    {
+        m_decimator.AddPoint(min_x + ((file.GetX(point) - start_x) / x_increment),
+                             min_y - ((file.GetY(column, point) - m_y_min) / y_increment));
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DecodeChunk()
+//|
+//| PARAMETERS:
+//|    chunk  (I) - The chunk.
+//|    column (I) - The index of the column to decode.
+//|
+//| FUNCTION:
+//|    This method returns the points of a column of an archived chunk.
+//|    The last few columns decoded are kept so that a plot panned back
+//|    over the archive only decodes each chunk once. The copy that was
+//|    used least recently makes way for a new one.
+//|
+//| RETURNS:
+//|    The decoded points, which are valid until the next call.
+//|
+//+------------------------------------------------------------------------------
+const wxTrendPlotDecodedChunk& wxTrendPlot::DecodeChunk(const wxTrendPlotChunk& chunk,
+                                                        size_t                  column)
+{
+    size_t oldest = 0;
+    
+    m_decode_clock++;
+    
+    for(size_t index = 0; index < m_decoded.size(); index++)
+    {
+        wxTrendPlotDecodedChunk& decoded = m_decoded[index];
         
-        if(m_zoom_factor != 1.0)
+        if(decoded.id == chunk.GetId() &&
+           decoded.column == column &&
+           decoded.x.size() == chunk.GetCount())
         {
-            dc->DrawText(wxString::Format(wxT("Zoom: %.1f%%"), m_zoom_factor * 100), rect.width - 80, rect.y + 15);
+            decoded.used = m_decode_clock;
+            return decoded;
         }
         
-        
-        // Now draw the legend
-        if(m_show_legend)
+        if(decoded.used < m_decoded[oldest].used)
         {
-            int x = rect.x + rect.width - right_pad + 10;
-            int y = 50;
-            
-            dc->SetBrush(wxColour(0xE0, 0xE0, 0xE0));
-            dc->DrawRectangle(rect.x + rect.width - right_pad + 5, y, right_pad - 8, 18);
-            dc->SetTextForeground(wxColour(0x0, 0x0, 0x0));
-            dc->DrawText(wxT("Legend:"), x, y);
-            
-            dc->SetTextForeground(wxColour(0xA0, 0xA0, 0xA0));
-            int save_y = y;
-            int height = 0;
-            y += 17;
-            for(size_t index = 0; index < m_data_sets.size(); index++)
-            {
-                y += 18;
-                height += 18;
-            }
-            dc->SetBrush(wxColour(0xF0, 0xF0, 0xF0));
-            dc->DrawRectangle(rect.x + rect.width - right_pad + 5, y-height,
-                             right_pad - 8, height + 2);
-                             
-            y = save_y;
-            y += 20;
-            
-            for(size_t index = 0; index < m_data_sets.size(); index++)
-            {
-                dc->SetBrush(m_data_sets[index].m_color);
-                
-                dc->DrawRectangle(x, y, 15, 15);
-                dc->DrawText(m_data_sets[index].m_label, x + 18, y);
-                y += 18;
-                height += 18;
-            }
+            oldest = index;
         }
-    } // end of if(m_antialiasing)
-
+    }
+    
+    if(m_decoded.size() < TREND_PLOT_DECODED_CHUNKS)
+    {
+        oldest = m_decoded.size();
+        m_decoded.resize(oldest + 1);
+    }
+    
+    wxTrendPlotDecodedChunk& decoded = m_decoded[oldest];
+    
+    decoded.id = chunk.GetId();
+    decoded.column = column;
+    decoded.used = m_decode_clock;
+    chunk.Decode(column, decoded.x, decoded.y);
+    
+    return decoded;
 }
 
 
@@ -1168,6 +3335,11 @@ void wxTrendPlot::OnKeyDown(wxKeyEvent& event)
 void wxTrendPlot::OnSize(wxSizeEvent& event)
 {
     wxRect rect = GetClientRect();
+    
+    if(m_renderer == RENDER_CAIRO_BUFFER)
+    {
+        m_buffer.Resize(rect.width, rect.height);
+    }
 
     // If the graph is currently not exposed then don't
     // draw it un-necessarily. Otherwise we waste processor
@@ -1200,6 +3372,19 @@ void wxTrendPlot::OnPaint(wxPaintEvent &WXUNUSED(event))
 {
     wxPaintDC dc(this);
     
+    // The scene was handed to the render thread by Refresh(), so
+    // all that is left is to show the newest frame it has drawn.
+    if(m_renderer == RENDER_CAIRO_THREAD)
+    {
+        ShowFrame(dc);
+        return;
+    }
+    
+    m_scheduler.FrameRendered();
+    
+    // Pick up any points posted since the plot was last idle
+    DrainQueues();
+    
     wxRect rect = GetClientRect();
     
     if(rect.width == 0 || rect.height == 0)
@@ -1277,59 +3462,20 @@ void wxTrendPlot::OnPaint(wxPaintEvent &WXUNUSED(event))
             
             break;
         }
-        // In this case it would make an awful lot of sense to perform
-        // the malloc calls and the creation of the cairo surface in
-        // the onsize method. This would prevent the overhead of all
-        // this allocation on every paint call. We could also move the
-        // wxImage constructor there as well.
+        // The buffer, cairo surface and bitmap are kept between
+        // paints and only re-allocated when the size changes so
+        // painting doesn't allocate any memory.
         case RENDER_CAIRO_BUFFER:
         {
-            //SetStatusText("Rending to a buffer and copying over");
-            
-            unsigned char* image_buffer = (unsigned char*)malloc(rect.width * rect.height * 4);
-            unsigned int image_buffer_len = rect.width * rect.height * 4;
-            
-            cairo_surface_t* cairo_surface = cairo_image_surface_create_for_data(
-                                            image_buffer,
-                                            CAIRO_FORMAT_RGB24,
-                                            rect.width,
-                                            rect.height,
-                                            rect.width * 4);
-            cairo_t* cairo_image = cairo_create(cairo_surface);
+            m_buffer.Resize(rect.width, rect.height);
             
-            Draw(true, cairo_image);
+            cairo_t* cairo_image = m_buffer.Begin();
             
-            // Now translate the raw image data from the format stored
-            // by cairo into a format understood by wxImage.
-            unsigned char* output = (unsigned char*)malloc(image_buffer_len);
-            int offset = 0;
-            for(size_t count = 0; count < image_buffer_len; count+=4)
+            if(cairo_image != NULL)
             {
-                int r = *(image_buffer+count+2);
-                *(output + offset) = r;
-                offset++;
-                int g = *(image_buffer+count+1);
-                *(output + offset) = g;
-                offset++;
-                int b = *(image_buffer+count+0);
-                *(output + offset) = b;
-                offset++;
-            } 
-            
-            
-            wxImage img(rect.width, rect.height, output, true);
-            wxBitmap bmp(img);
-            wxClientDC client_dc(this);
-            
-            // Create a double buffer to draw the plot
-            // on screen to prevent flicker from occuring.
-            wxBufferedDC dc;
-            dc.Init(&client_dc, bmp);
-            
-            cairo_destroy(cairo_image);
-            cairo_surface_destroy(cairo_surface);
-            free(image_buffer);
-            free(output);
+                Draw(true, cairo_image);
+                m_buffer.End(dc);
+            }
             break;
         }
         
@@ -1355,6 +3501,47 @@ void wxTrendPlot::OnPaint(wxPaintEvent &WXUNUSED(event))
 }
 
 
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ShowFrame()
+//|
+//| PARAMETERS:
+//|    dc (I) - The device context to draw the frame on.
+//|
+//| FUNCTION:
+//|    This method copies the newest frame finished by the render thread
+//|    onto the device context through the off-screen buffer, which takes
+//|    care of converting it to a bitmap. Nothing is drawn until the
+//|    thread has finished its first frame.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlot::ShowFrame(wxDC& dc)
+{
+    cairo_surface_t* frame = m_render_thread->TakeFrame();
+    
+    if(frame == NULL)
+    {
+        return;
+    }
+    
+    m_buffer.Resize(cairo_image_surface_get_width(frame),
+                    cairo_image_surface_get_height(frame));
+    
+    cairo_t* cairo_image = m_buffer.Begin();
+    
+    if(cairo_image != NULL)
+    {
+        cairo_set_source_surface(cairo_image, frame, 0, 0);
+        cairo_paint(cairo_image);
+        m_buffer.End(dc);
+    }
+}
+
+
 /*
 +------------------------------------------------------------------------------
 |
@@ -55,11 +55,69 @@
 #include <wx/dcbuffer.h>
 #include <wx/colordlg.h>
 #include <wx/artprov.h>
+#include <wx/hashmap.h>
 
 #include <vector>
 #include "wx/trend_plot_dataset.h"
+#include "wx/trend_plot_dataset_map.h"
+#include "wx/trend_plot_decimator.h"
+#include "wx/trend_plot_renderer.h"
+#include "wx/trend_plot_scene.h"
+#include "wx/trend_plot_strip.h"
+#include "wx/trend_plot_ticks.h"
+#include "wx/trend_plot_tiles.h"
+#include "wx/cairo_buffer.h"
+#include "wx/frame_scheduler.h"
 #include "wx/wxcairo.h"
 
+#include <cairo.h>
+
+// The fewest pixels between the ticks along each axis
+#define TREND_PLOT_X_TICK_SPACING 60
+#define TREND_PLOT_Y_TICK_SPACING 30
+
+// Identifies the font a tick label was measured in
+#define TREND_PLOT_CAIRO_LABEL_FONT 0
+#define TREND_PLOT_DC_LABEL_FONT    1
+
+// How much of the y axis may go unused before it is rescaled
+#define TREND_PLOT_DEFAULT_HYSTERESIS 0.2
+
+// The number of decoded chunks of the archives kept for drawing
+#define TREND_PLOT_DECODED_CHUNKS 16
+
+// The most frames taken off the queue of a data set at a time
+#define TREND_PLOT_DRAIN_BATCH 1024
+
+// Maps the id of an item of the delete menu to its data set
+WX_DECLARE_HASH_MAP(int, wxTrendPlotHandle, wxIntegerHash, wxIntegerEqual, wxTrendPlotMenuMap);
+
+// Called with the number of frames evicted from the frame group of a
+// data set since the last call.
+typedef void (*wxTrendPlotEvictionCallback)(wxTrendPlotHandle set_handle,
+                                            wxUint64          count,
+                                            void*             context);
+
+
+//+------------------------------------------------------------------------------
+//|
+//| STRUCTURE:
+//|    wxTrendPlotDecodedChunk
+//|
+//| DESCRIPTION:
+//|    This structure holds the points of a column of an archived chunk
+//|    once they have been decoded for drawing.
+//|
+//+------------------------------------------------------------------------------
+struct wxTrendPlotDecodedChunk
+{
+    wxUint64            id;
+    size_t              column;
+    unsigned long       used;
+    std::vector<double> x;
+    std::vector<double> y;
+};
+
 
 //+------------------------------------------------------------------------------
 //|
@@ -86,53 +144,208 @@ class wxTrendPlot: public wxScrolledWindow
         // set or remove the clipping region
         void Clip(bool clip) { m_clip = clip; Refresh(); }
         
+        // Draw the plot as a strip chart. Only the part of the graph
+        // that has scrolled into view is drawn on each frame. This
+        // is only supported by the cairo renderers that draw on the
+        // GUI thread; RENDER_CAIRO_THREAD ignores it.
+        void SetStripChart(bool strip_chart)
+        {
+            m_strip_chart = strip_chart;
+            m_strip.Invalidate();
+            Refresh(false);
+        }
+        
+        // Draw the lines in vertical tiles shared out between this many
+        // worker threads and the thread drawing the frame. 0 draws them
+        // on one thread. The tiles are only used when cairo draws into
+        // an image surface, as it does for RENDER_CAIRO_THREAD, and not
+        // for strip charts.
+        bool SetTileThreads(int threads);
+        
+        // Scale the y axis to fit the points that are visible. The
+        // axis is only rescaled once the points go outside it or use
+        // less than 1 - hysteresis of it, and then it is left with
+        // hysteresis to spare, so it doesn't jitter. It is off to
+        // begin with, leaving the axis at 0 to 5.
+        void SetAutoScale(bool   autoscale,
+                          double hysteresis = TREND_PLOT_DEFAULT_HYSTERESIS);
+        
+        // Fix the range of the y axis, which turns off the
+        // autoscaling.
+        void SetYRange(double min_y, double max_y);
+        
         // Add a point to a particular data set within
         // this plot.
-        bool AddPoint(size_t set_handle, double x, double y);
+        bool AddPoint(wxTrendPlotHandle set_handle, double x, double y);
+        
+        // Add a block of points to a data set
+        bool AddPoints(wxTrendPlotHandle set_handle,
+                       const double*     x,
+                       const double*     y,
+                       size_t            count);
+        
+        // Add a point with the same x to each of the first
+        // count data sets in the order they were added.
+        bool AddRow(double x, const double* y, size_t count);
+        
+        // Add a frame to the group of data sets that the data set
+        // belongs to. There must be a y for each data set of the
+        // group in the order they were added.
+        bool AddFrame(wxTrendPlotHandle set_handle, double x, const double* y);
+        
+        // Add a block of frames to a group of data sets. The y
+        // co-ordinates are stored a frame at a time.
+        bool AddFrames(wxTrendPlotHandle set_handle,
+                       const double*     x,
+                       const double*     y,
+                       size_t            count);
+        
+        // Add the next samples to a data set added with
+        // AddUniformDataSet().
+        bool AddSamples(wxTrendPlotHandle set_handle,
+                        const double*     y,
+                        size_t            count);
+        
+        // Get the queue used to add points to a data set from
+        // threads other than the GUI thread. The data sets of a
+        // frame group share a queue that takes whole frames.
+        wxTrendPlotQueuePtr GetQueue(wxTrendPlotHandle set_handle);
+        
+        // Add a data set to the plot. The capacity is the number
+        // of points kept before the oldest ones are discarded and
+        // the encoding says how the y co-ordinates are stored.
+        // The handle returned stays valid until the data set is
+        // removed, whatever happens to the other data sets.
+        wxTrendPlotHandle AddDataSet(const wxString& label,
+                                     wxColour color,
+                                     size_t capacity = TREND_PLOT_DEFAULT_CAPACITY,
+                                     const wxTrendPlotEncoding& encoding = wxTrendPlotEncoding());
+        
+        // Add a data set that is sampled every dt from x0. The x
+        // co-ordinates aren't stored and the visible points are found
+        // without searching. Points are added with AddSamples(), or
+        // with AddPoint() which puts them at the nearest sample and
+        // leaves any samples it skips over as gaps in the line.
+        wxTrendPlotHandle AddUniformDataSet(const wxString& label,
+                                            wxColour        color,
+                                            double          x0,
+                                            double          dt,
+                                            size_t          capacity = TREND_PLOT_DEFAULT_CAPACITY,
+                                            const wxTrendPlotEncoding& encoding = wxTrendPlotEncoding());
+        
+        // Add a data set whose points are also recorded in a memory
+        // mapped file, creating the file with room for file_capacity
+        // points if it doesn't exist. An existing file is reopened
+        // without reading it through and the newest points in it are
+        // shown straight away. The capacity is the number of points
+        // kept in memory, the rest are drawn from the file. Returns a
+        // handle that isn't IsOk() if the file can't be opened.
+        wxTrendPlotHandle AddFileDataSet(const wxString& path,
+                                         const wxString& label,
+                                         wxColour        color,
+                                         size_t          file_capacity,
+                                         size_t          capacity = TREND_PLOT_DEFAULT_CAPACITY);
+        
+        // Add data sets that are sampled together. They share a
+        // single copy of the x co-ordinates and are added to a frame
+        // at a time with AddFrame() instead of AddPoint(), or through
+        // their shared queue from other threads. The handle of each
+        // data set is written to handles.
+        void AddFrameGroup(const wxString*    labels,
+                           const wxColour*    colors,
+                           size_t             count,
+                           wxTrendPlotHandle* handles,
+                           size_t             capacity = TREND_PLOT_DEFAULT_CAPACITY,
+                           const wxTrendPlotEncoding& encoding = wxTrendPlotEncoding());
+        
+        // Remove a data set from the plot. Returns false if the
+        // data set has already been removed.
+        bool RemoveDataSet(wxTrendPlotHandle set_handle);
         
-        size_t AddDataSet(const wxString& label, wxColour color);
-        void RemoveDataSet(std::vector<wxTrendPlotDataset>::iterator& match);
+        // Limit how much history the frame group of a data set
+        // keeps. Older points are evicted as new ones are added.
+        bool SetRetention(wxTrendPlotHandle           set_handle,
+                          const wxTrendPlotRetention& retention);
         
+        // The total number of points evicted from a data set
+        wxUint64 GetEvictedCount(wxTrendPlotHandle set_handle);
+        
+        // Keep the points pushed out of the frame group of a data
+        // set in compressed chunks that are decoded when the plot
+        // is panned back over them.
+        bool SetArchive(wxTrendPlotHandle set_handle, bool archive);
+        
+        // Set a function to be called from the GUI thread whenever
+        // points are evicted from a data set. It mustn't add or
+        // remove data sets.
+        void SetEvictionCallback(wxTrendPlotEvictionCallback callback,
+                                 void*                       context = NULL)
+        {
+            m_eviction_callback = callback;
+            m_eviction_context = context;
+        }
+        
+        // Ask for the plot to be repainted. This can be called as
+        // often as needed, the plot is painted at most once per
+        // frame of the scheduler.
         void UpdatePlot(void);
 
+        // Repaint the plot. With RENDER_CAIRO_THREAD a new scene is
+        // handed to the render thread instead and the plot is repainted
+        // once the thread has drawn it.
+        virtual void Refresh(bool          erase_background = true,
+                             const wxRect* rect = NULL);
+
+        wxFrameScheduler& GetFrameScheduler(void)
+        {
+            return m_scheduler;
+        }
+
         void SetStatusText(const wxString& text);
         
         void SetTitle(const wxString& title, bool show=false)
         {
             m_title = title;
             m_show_title = show;
+            InvalidateChrome();
         }
         
         void ShowTitle(bool show)
         {
             m_show_title = show;
+            InvalidateChrome();
         }
         
         void SetXAxisTitle(const wxString& title, bool show=false)
         {
             m_x_axis_title = title;
             m_show_x_axis_title = show;
+            InvalidateChrome();
         }
         
         void ShowXAxisTitle(bool show)
         {
             m_show_x_axis_title = show;
+            InvalidateChrome();
         }
         
         void SetYAxisTitle(const wxString& title, bool show=false)
         {
             m_y_axis_title = title;
             m_show_y_axis_title = show;
+            InvalidateChrome();
         }
         
         void ShowYAxisTitle(bool show)
         {
             m_show_y_axis_title = show;
+            InvalidateChrome();
         }
         
         void ShowLegend(bool show)
         {
             m_show_legend = show;
+            InvalidateChrome();
         }
         
         void Activate(bool active)
@@ -148,13 +361,108 @@ class wxTrendPlot: public wxScrolledWindow
         
         size_t GetPlotCount(void)
         {
-            return m_data_sets.size();
+            return m_data_sets.GetCount();
         }
         
         void Pause(bool pause);
     
     private:
         void Draw(bool use_cairo, void*    drawer, double start_x = 0);
+        void BuildScene(cairo_t*      cairo_image,
+                        const wxRect& rect,
+                        double        start_x,
+                        bool          lines);
+        void SubmitScene(void);
+        void ShowFrame(wxDC& dc);
+        void StopRenderThread(void);
+        void DrawChrome(cairo_t* cairo_image, const wxRect& rect);
+        void UpdateChrome(cairo_t* cairo_image, const wxRect& rect);
+        void AutoScale(double start_x);
+        void SetYAxis(double min_y, double max_y);
+        void DestroyChrome(void);
+
+        // Look up the label of a tick, measuring it in the font
+        // currently selected the first time it is used.
+        const wxTrendPlotTickLabel& MeasureLabel(cairo_t*          cairo_image,
+                                                 wxTrendPlotTicks& ticks,
+                                                 double            value);
+        const wxTrendPlotTickLabel& MeasureLabel(wxDC*             dc,
+                                                 wxTrendPlotTicks& ticks,
+                                                 double            value);
+
+        // Force the static parts of the plot to be redrawn
+        void InvalidateChrome(void)
+        {
+            m_chrome_valid = false;
+        }
+        
+        wxTrendPlotHandle InsertDataSet(wxTrendPlotDataset* data,
+                                        const wxString&     label,
+                                        wxColour            color);
+        
+        // Forget the screen x co-ordinates worked out for the
+        // last frame group that was drawn.
+        void ResetScreenX(void)
+        {
+            m_screen_group = NULL;
+        }
+
+        const std::vector<wxPoint>& DecimateDataSet(const wxTrendPlotDataset& data,
+                                                    double start_x,
+                                                    int    min_x,
+                                                    int    max_x,
+                                                    int    min_y,
+                                                    double x_increment,
+                                                    double y_increment,
+                                                    bool   summarise);
+        void DecimateArchive(const wxTrendPlotDataset& data,
+                             double start_x,
+                             double end_x,
+                             int    min_x,
+                             int    min_y,
+                             double x_increment,
+                             double y_increment,
+                             bool   summarise);
+        void DecimateFile(const wxTrendPlotDataset& data,
+                          double start_x,
+                          double end_x,
+                          int    min_x,
+                          int    max_x,
+                          int    min_y,
+                          double x_increment,
+                          double y_increment,
+                          bool   summarise);
+        const wxTrendPlotDecodedChunk& DecodeChunk(const wxTrendPlotChunk& chunk,
+                                                   size_t                  column);
+        void AddBucket(const wxTrendPlotBucket& bucket,
+                       double                   start_x,
+                       int                      min_x,
+                       int                      min_y,
+                       double                   x_increment,
+                       double                   y_increment);
+        void StrokeDataSets(cairo_t*      cairo_image,
+                            double        start_x,
+                            int           min_x,
+                            int           max_x,
+                            int           min_y,
+                            double        x_increment,
+                            double        y_increment,
+                            const wxRect& visible,
+                            bool          summarise);
+        void DrawStrip(cairo_t* cairo_image,
+                       double   start_x,
+                       int      min_x,
+                       int      max_x,
+                       int      min_y,
+                       int      max_y,
+                       double   x_increment,
+                       double   y_increment);
+        void InvalidateStrip(const wxTrendPlotDataset& data, double x);
+        void FollowPoint(double x);
+        void ReportEvictions(wxTrendPlotHandle set_handle, wxTrendPlotDataset& data);
+        void ReplaceQueue(const wxTrendPlotQueuePtr& old_queue);
+        bool DrainQueues(void);
+        void OnIdle(wxIdleEvent& event);
         void OnSize(wxSizeEvent& event);
         void OnMouseMove(wxMouseEvent& event);
         void OnMouseDClick(wxMouseEvent& event);
@@ -171,6 +479,8 @@ class wxTrendPlot: public wxScrolledWindow
         int m_menu_zoomin;
         int m_menu_zoomout;
         int m_menu_pause;
+        int m_menu_strip_chart;
+        int m_menu_autoscale;
         int m_menu_plotconfig;
         int m_menu_delete_submenu;
         
@@ -180,13 +490,26 @@ class wxTrendPlot: public wxScrolledWindow
         int m_menu_native_render;
         int m_menu_cairo_render_buffer;
         int m_menu_cairo_render_native;
+        int m_menu_cairo_render_thread;
         
 
         double m_end_point;
         
         int m_mouse_x;
         double m_start_plot_x;
-        std::vector<wxTrendPlotDataset> m_data_sets;
+        wxTrendPlotDatasetMap m_data_sets;
+        
+        // The data set removed by each item of the delete menu
+        wxTrendPlotMenuMap m_delete_menu_ids;
+        
+        // Told about points evicted by the retention policies
+        wxTrendPlotEvictionCallback m_eviction_callback;
+        void*                       m_eviction_context;
+        
+        // The frames taken off a queue, kept to save allocating
+        // them each time the queues are drained.
+        std::vector<double> m_drain_x;
+        std::vector<double> m_drain_y;
         
         bool m_show_title;
         wxString m_title;
@@ -199,18 +522,75 @@ class wxTrendPlot: public wxScrolledWindow
         
         double m_x_axis_width;
         double m_zoom_factor;
+        
+        // The range of the y axis and whether it follows the
+        // visible points.
+        double m_y_min;
+        double m_y_max;
+        bool   m_autoscale;
+        double m_hysteresis;
+
+        // The ticks along each axis and their labels
+        wxTrendPlotTicks m_x_ticks;
+        wxTrendPlotTicks m_y_ticks;
+
         bool m_show_legend;
         
         bool m_is_active;
         bool m_is_paused;
         double m_pause_point;
 
-        unsigned char* m_image_data;
-        unsigned int   m_image_data_length;
-
         bool m_antialiasing;
 
-        void* m_cairo_image;
+        // The off-screen buffer used by RENDER_CAIRO_BUFFER, and by
+        // RENDER_CAIRO_THREAD to show the frames drawn by the thread.
+        wxCairoBuffer m_buffer;
+
+        // The frame being drawn with cairo, once the data sets have
+        // been reduced to what is on screen.
+        wxTrendPlotScene m_scene;
+
+        // Draws the frames for RENDER_CAIRO_THREAD
+        wxTrendPlotRenderer* m_render_thread;
+
+        // Draws the lines in parallel tiles
+        wxTrendPlotTilePool m_tiles;
+
+        // Limits how often the plot is repainted
+        wxFrameScheduler m_scheduler;
+
+        // Used to reduce each line to the points that are visible
+        // on screen before drawing it.
+        wxTrendPlotDecimator m_decimator;
+        
+        // The visible frames of the last frame group drawn and their
+        // screen x co-ordinates, which are shared by each data set
+        // of the group while a frame is being drawn.
+        const wxTrendPlotFrameGroup* m_screen_group;
+        bool                         m_screen_found;
+        size_t                       m_screen_first;
+        size_t                       m_screen_last;
+        std::vector<int>             m_screen_x;
+        
+        // The chunks of the archives decoded most recently
+        std::vector<wxTrendPlotDecodedChunk> m_decoded;
+        unsigned long                        m_decode_clock;
+
+        // A copy of the parts of the plot drawn with cairo that don't
+        // change between frames. The padding around the graph is
+        // worked out when it is drawn.
+        cairo_surface_t* m_chrome;
+        bool m_chrome_valid;
+        int m_chrome_width;
+        int m_chrome_height;
+        int m_bottom_pad;
+        int m_top_pad;
+        int m_left_pad;
+        int m_right_pad;
+
+        // The ring of pixel columns used to draw a strip chart
+        bool m_strip_chart;
+        wxTrendPlotStrip m_strip;
 
 };
 
@@ -0,0 +1,124 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_atomic.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the integer shared between the
+//|    threads that feed and draw a trend plot.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_ATOMIC_H__
+#define __TREND_PLOT_ATOMIC_H__
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    #pragma intrinsic(_InterlockedCompareExchange)
+    #pragma intrinsic(_InterlockedExchange)
+    #pragma intrinsic(_InterlockedExchangeAdd)
+#endif
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotAtomic
+//|
+//| DESCRIPTION:
+//|    This class is a long that can be read and changed by several threads
+//|    at once without a lock, using the interlocked functions of the
+//|    compiler. Reads acquire and writes release, so anything written
+//|    before a value is stored is seen by a thread that loads it, and the
+//|    read-modify-write operations are full barriers.
+//|
+//|    Visual C++ gives volatile reads and writes acquire and release
+//|    semantics. GCC uses its __atomic functions when it has them and
+//|    otherwise puts a full barrier either side.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotAtomic
+{
+    public:
+        wxTrendPlotAtomic(long value = 0)
+        {
+            m_value = value;
+        }
+
+        long Load(void) const
+        {
+#if defined(_MSC_VER)
+            return m_value;
+#elif defined(__ATOMIC_ACQUIRE)
+            return __atomic_load_n(&m_value, __ATOMIC_ACQUIRE);
+#else
+            long value = m_value;
+            __sync_synchronize();
+
+            return value;
+#endif
+        }
+
+        void Store(long value)
+        {
+#if defined(_MSC_VER)
+            m_value = value;
+#elif defined(__ATOMIC_RELEASE)
+            __atomic_store_n(&m_value, value, __ATOMIC_RELEASE);
+#else
+            __sync_synchronize();
+            m_value = value;
+#endif
+        }
+
+        // Set the value to desired if it is still expected. Otherwise
+        // expected is set to the value found.
+        bool CompareExchange(long& expected, long desired)
+        {
+#if defined(_MSC_VER)
+            long found = _InterlockedCompareExchange(&m_value, desired, expected);
+#else
+            long found = __sync_val_compare_and_swap(&m_value, expected, desired);
+#endif
+
+            if(found == expected)
+            {
+                return true;
+            }
+
+            expected = found;
+
+            return false;
+        }
+
+        // Add to the value, returning what it was before
+        long FetchAdd(long delta)
+        {
+#if defined(_MSC_VER)
+            return _InterlockedExchangeAdd(&m_value, delta);
+#else
+            return __sync_fetch_and_add(&m_value, delta);
+#endif
+        }
+
+        // Replace the value, returning what it was before
+        long Exchange(long value)
+        {
+#if defined(_MSC_VER)
+            return _InterlockedExchange(&m_value, value);
+#elif defined(__ATOMIC_SEQ_CST)
+            return __atomic_exchange_n(&m_value, value, __ATOMIC_SEQ_CST);
+#else
+            // This is only an acquire barrier on its own
+            __sync_synchronize();
+
+            return __sync_lock_test_and_set(&m_value, value);
+#endif
+        }
+
+    private:
+        volatile long m_value;
+};
+
+#endif // __TREND_PLOT_ATOMIC_H__
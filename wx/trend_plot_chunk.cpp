@@ -0,0 +1,815 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_chunk.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the class used to keep
+//|    old frames of a trend plot frame group in compressed form.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <cmath>
+#include <cstring>
+
+#include "wx/trend_plot_chunk.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ToBits()
+//|
+//| PARAMETERS:
+//|    value (I) - The value.
+//|
+//| FUNCTION:
+//|    This function returns the bit pattern of a double.
+//|
+//| RETURNS:
+//|    The bit pattern.
+//|
+//+------------------------------------------------------------------------------
+static wxUint64 ToBits(double value)
+{
+    wxUint64 bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    return bits;
+}
+
+
+static double FromBits(wxUint64 bits)
+{
+    double value;
+
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    LeadingZeros()
+//|
+//| PARAMETERS:
+//|    value (I) - The value, which can't be 0.
+//|
+//| FUNCTION:
+//|    This function counts the zero bits above the highest bit set.
+//|
+//| RETURNS:
+//|    The number of bits.
+//|
+//+------------------------------------------------------------------------------
+static int LeadingZeros(wxUint64 value)
+{
+    int count = 0;
+
+    for(int shift = 32; shift != 0; shift /= 2)
+    {
+        if((value >> (64 - shift)) == 0)
+        {
+            count += shift;
+            value <<= shift;
+        }
+    }
+
+    return count;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    TrailingZeros()
+//|
+//| PARAMETERS:
+//|    value (I) - The value, which can't be 0.
+//|
+//| FUNCTION:
+//|    This function counts the zero bits below the lowest bit set.
+//|
+//| RETURNS:
+//|    The number of bits.
+//|
+//+------------------------------------------------------------------------------
+static int TrailingZeros(wxUint64 value)
+{
+    int count = 0;
+
+    for(int shift = 32; shift != 0; shift /= 2)
+    {
+        if((value << (64 - shift)) == 0)
+        {
+            count += shift;
+            value >>= shift;
+        }
+    }
+
+    return count;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Write()
+//|
+//| PARAMETERS:
+//|    value (I) - The bits to write in the lowest bits.
+//|    count (I) - The number of bits, from 1 to 64.
+//|
+//| FUNCTION:
+//|    This method appends bits to the end of the stream.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotChunk::Stream::Write(wxUint64 value, int count)
+{
+    if(count < 64)
+    {
+        value &= ((wxUint64)1 << count) - 1;
+    }
+
+    int offset = (int)(bits % 64);
+
+    if(offset == 0)
+    {
+        words.push_back(0);
+    }
+
+    int space = 64 - offset;
+
+    if(count <= space)
+    {
+        words.back() |= value << (space - count);
+    }
+    else
+    {
+        words.back() |= value >> (count - space);
+        words.push_back(value << (64 - (count - space)));
+    }
+
+    bits += count;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Read()
+//|
+//| PARAMETERS:
+//|    position (IO) - The bit to read from, which is moved past the bits
+//|                    read.
+//|    count    (I)  - The number of bits, from 1 to 64.
+//|
+//| FUNCTION:
+//|    This method reads bits from the stream.
+//|
+//| RETURNS:
+//|    The bits in the lowest bits of the value.
+//|
+//+------------------------------------------------------------------------------
+wxUint64 wxTrendPlotChunk::Stream::Read(size_t& position, int count) const
+{
+    size_t word = position / 64;
+    int space = 64 - (int)(position % 64);
+    wxUint64 value;
+
+    if(count <= space)
+    {
+        value = words[word] >> (space - count);
+    }
+    else
+    {
+        value = (words[word] << (count - space)) |
+                (words[word + 1] >> (64 - (count - space)));
+    }
+
+    if(count < 64)
+    {
+        value &= ((wxUint64)1 << count) - 1;
+    }
+
+    position += count;
+
+    return value;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotChunk()
+//|
+//| PARAMETERS:
+//|    columns (I) - The number of y co-ordinates in each frame.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for a chunk that stores the x co-ordinate
+//|    of each frame.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotChunk::wxTrendPlotChunk(size_t columns)
+{
+    m_uniform = false;
+    m_x0 = 0;
+    m_dt = 1;
+    m_first_sample = 0;
+
+    Initialise(columns);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotChunk()
+//|
+//| PARAMETERS:
+//|    columns      (I) - The number of y co-ordinates in each frame.
+//|    x0           (I) - The x co-ordinate of sample 0.
+//|    dt           (I) - The distance between samples.
+//|    first_sample (I) - The sample number of the first frame.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for a chunk of a uniform group. The frames
+//|    are consecutive samples so no x co-ordinates are stored.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotChunk::wxTrendPlotChunk(size_t columns,
+                                   double x0,
+                                   double dt,
+                                   double first_sample)
+{
+    m_uniform = true;
+    m_x0 = x0;
+    m_dt = dt;
+    m_first_sample = first_sample;
+
+    Initialise(columns);
+}
+
+
+void wxTrendPlotChunk::Initialise(size_t columns)
+{
+    m_count = 0;
+    m_sealed = false;
+    m_id = NextId();
+    m_first_x = 0;
+    m_last_x = 0;
+
+    m_x.bits = 0;
+    m_previous_x = 0;
+    m_previous_delta = 0;
+
+    m_columns.resize(columns);
+    m_summary.resize(columns);
+
+    for(size_t index = 0; index < columns; index++)
+    {
+        m_columns[index].stream.bits = 0;
+        m_summary[index].count = 0;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    NextId()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method hands out the ids of chunks. Chunks are only created
+//|    and changed by the GUI thread.
+//|
+//| RETURNS:
+//|    An id that hasn't been used before.
+//|
+//+------------------------------------------------------------------------------
+wxUint64 wxTrendPlotChunk::NextId(void)
+{
+    static wxUint64 next_id = 0;
+
+    return ++next_id;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddFrame()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the frame.
+//|    y (I) - The y co-ordinate for each column.
+//|
+//| FUNCTION:
+//|    This method compresses a frame onto the end of the chunk.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotChunk::AddFrame(double x, const double* y)
+{
+    if(m_uniform)
+    {
+        x = m_x0 + ((m_first_sample + m_count) * m_dt);
+    }
+    else
+    {
+        EncodeX(x);
+    }
+
+    for(size_t index = 0; index < m_columns.size(); index++)
+    {
+        EncodeY(m_columns[index], y[index]);
+        Summarise(m_summary[index], x, y[index]);
+    }
+
+    if(m_count == 0)
+    {
+        m_first_x = x;
+    }
+
+    m_last_x = x;
+    m_count++;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    EncodeX()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the next frame.
+//|
+//| FUNCTION:
+//|    This method stores the change in the difference between the bit
+//|    patterns of the x co-ordinates. The first frame is stored whole,
+//|    then the delta of the delta takes 1 bit if it is 0, 9 bits if it
+//|    fits in 7 bits, 12 bits if it fits in 9 bits and 16 bits if it fits
+//|    in 12 bits. Anything bigger takes 68 bits.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotChunk::EncodeX(double x)
+{
+    wxUint64 bits = ToBits(x);
+
+    if(m_count == 0)
+    {
+        m_x.Write(bits, 64);
+    }
+    else
+    {
+        wxUint64 delta = bits - m_previous_x;
+        wxInt64 change = (wxInt64)(delta - m_previous_delta);
+
+        if(change == 0)
+        {
+            m_x.Write(0, 1);
+        }
+        else if(change >= -63 && change <= 64)
+        {
+            m_x.Write(2, 2);
+            m_x.Write(change + 63, 7);
+        }
+        else if(change >= -255 && change <= 256)
+        {
+            m_x.Write(6, 3);
+            m_x.Write(change + 255, 9);
+        }
+        else if(change >= -2047 && change <= 2048)
+        {
+            m_x.Write(14, 4);
+            m_x.Write(change + 2047, 12);
+        }
+        else
+        {
+            m_x.Write(15, 4);
+            m_x.Write((wxUint64)change, 64);
+        }
+
+        m_previous_delta = delta;
+    }
+
+    m_previous_x = bits;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    EncodeY()
+//|
+//| PARAMETERS:
+//|    column (IO) - The column to add to.
+//|    y      (I)  - The y co-ordinate of the next frame.
+//|
+//| FUNCTION:
+//|    This method stores a y co-ordinate XORed with the one before it.
+//|    A value that didn't change takes a single bit. Otherwise the bits
+//|    that changed are stored, reusing the position of the last change
+//|    if they fit inside it, or with 11 bits giving their position if
+//|    they don't. The first value of a column is stored whole.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotChunk::EncodeY(Column& column, double y)
+{
+    wxUint64 bits = ToBits(y);
+
+    if(column.stream.bits == 0)
+    {
+        column.stream.Write(bits, 64);
+        column.previous = bits;
+        column.leading = -1;
+        column.trailing = 0;
+        return;
+    }
+
+    wxUint64 change = bits ^ column.previous;
+
+    column.previous = bits;
+
+    if(change == 0)
+    {
+        column.stream.Write(0, 1);
+        return;
+    }
+
+    int leading = LeadingZeros(change);
+    int trailing = TrailingZeros(change);
+
+    // The position is stored in 5 bits
+    if(leading > 31)
+    {
+        leading = 31;
+    }
+
+    if(column.leading >= 0 &&
+       leading >= column.leading &&
+       trailing >= column.trailing)
+    {
+        column.stream.Write(2, 2);
+        column.stream.Write(change >> column.trailing,
+                            64 - column.leading - column.trailing);
+        return;
+    }
+
+    int length = 64 - leading - trailing;
+
+    column.stream.Write(3, 2);
+    column.stream.Write(leading, 5);
+    column.stream.Write(length, 6);
+    column.stream.Write(change >> trailing, length);
+
+    column.leading = leading;
+    column.trailing = trailing;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Summarise()
+//|
+//| PARAMETERS:
+//|    summary (IO) - The summary of a column.
+//|    x       (I)  - The x co-ordinate of the next frame.
+//|    y       (I)  - The y co-ordinate of the next frame.
+//|
+//| FUNCTION:
+//|    This method adds a point to the summary of a column. Gaps in the
+//|    data are left out of the minimum and maximum.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotChunk::Summarise(wxTrendPlotBucket& summary, double x, double y)
+{
+    if(summary.count == 0)
+    {
+        summary.first_x = x;
+        summary.first_y = y;
+        summary.min_x = x;
+        summary.min_y = y;
+        summary.max_x = x;
+        summary.max_y = y;
+    }
+    else if(summary.min_y != summary.min_y)
+    {
+        // Only gaps so far, which have no minimum or maximum
+        summary.min_x = x;
+        summary.min_y = y;
+        summary.max_x = x;
+        summary.max_y = y;
+    }
+    else if(y < summary.min_y)
+    {
+        summary.min_x = x;
+        summary.min_y = y;
+    }
+    else if(y > summary.max_y)
+    {
+        summary.max_x = x;
+        summary.max_y = y;
+    }
+
+    summary.last_x = x;
+    summary.last_y = y;
+    summary.count++;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Seal()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called once no more frames will be added. The
+//|    streams are trimmed to the storage they need by swapping them with
+//|    a copy, which only allocates the words in use.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotChunk::Seal(void)
+{
+    m_sealed = true;
+
+    std::vector<wxUint64>(m_x.words).swap(m_x.words);
+
+    for(size_t index = 0; index < m_columns.size(); index++)
+    {
+        std::vector<wxUint64>& words = m_columns[index].stream.words;
+
+        std::vector<wxUint64>(words).swap(words);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddColumn()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method adds a column to the chunk. The frames already in the
+//|    chunk read as 0, which costs a bit each.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotChunk::AddColumn(void)
+{
+    Column column;
+    wxTrendPlotBucket summary;
+
+    column.stream.bits = 0;
+    summary.count = 0;
+
+    for(size_t index = 0; index < m_count; index++)
+    {
+        EncodeY(column, 0);
+    }
+
+    // Only the first and last frames are needed to summarise a
+    // column that doesn't change.
+    if(m_count != 0)
+    {
+        Summarise(summary, m_first_x, 0);
+        Summarise(summary, m_last_x, 0);
+        summary.count = m_count;
+    }
+
+    m_columns.push_back(column);
+    m_summary.push_back(summary);
+    m_id = NextId();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    RemoveColumn()
+//|
+//| PARAMETERS:
+//|    column (I) - The index of the column.
+//|
+//| FUNCTION:
+//|    This method removes a column from the chunk.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotChunk::RemoveColumn(size_t column)
+{
+    m_columns.erase(m_columns.begin() + column);
+    m_summary.erase(m_summary.begin() + column);
+    m_id = NextId();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Decode()
+//|
+//| PARAMETERS:
+//|    column (I) - The index of the column.
+//|    x      (O) - The x co-ordinates of the frames.
+//|    y      (O) - The y co-ordinates of the column.
+//|
+//| FUNCTION:
+//|    This method decompresses the points of a column of the chunk.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotChunk::Decode(size_t               column,
+                              std::vector<double>& x,
+                              std::vector<double>& y) const
+{
+    x.resize(m_count);
+    y.resize(m_count);
+
+    if(m_count == 0)
+    {
+        return;
+    }
+
+    if(m_uniform)
+    {
+        for(size_t index = 0; index < m_count; index++)
+        {
+            x[index] = m_x0 + ((m_first_sample + index) * m_dt);
+        }
+    }
+    else
+    {
+        size_t position = 0;
+        wxUint64 bits = m_x.Read(position, 64);
+        wxUint64 delta = 0;
+
+        x[0] = FromBits(bits);
+
+        for(size_t index = 1; index < m_count; index++)
+        {
+            wxInt64 change = 0;
+
+            if(m_x.Read(position, 1) != 0)
+            {
+                if(m_x.Read(position, 1) == 0)
+                {
+                    change = (wxInt64)m_x.Read(position, 7) - 63;
+                }
+                else if(m_x.Read(position, 1) == 0)
+                {
+                    change = (wxInt64)m_x.Read(position, 9) - 255;
+                }
+                else if(m_x.Read(position, 1) == 0)
+                {
+                    change = (wxInt64)m_x.Read(position, 12) - 2047;
+                }
+                else
+                {
+                    change = (wxInt64)m_x.Read(position, 64);
+                }
+            }
+
+            delta += (wxUint64)change;
+            bits += delta;
+
+            x[index] = FromBits(bits);
+        }
+    }
+
+    const Stream& stream = m_columns[column].stream;
+    size_t position = 0;
+    wxUint64 bits = stream.Read(position, 64);
+    int leading = 0;
+    int trailing = 0;
+
+    y[0] = FromBits(bits);
+
+    for(size_t index = 1; index < m_count; index++)
+    {
+        if(stream.Read(position, 1) != 0)
+        {
+            if(stream.Read(position, 1) != 0)
+            {
+                leading = (int)stream.Read(position, 5);
+                int length = (int)stream.Read(position, 6);
+
+                // A length of 64 wraps round to 0
+                if(length == 0)
+                {
+                    length = 64;
+                }
+
+                trailing = 64 - leading - length;
+            }
+
+            bits ^= stream.Read(position, 64 - leading - trailing) << trailing;
+        }
+
+        y[index] = FromBits(bits);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetSize()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method works out the memory used by the chunk.
+//|
+//| RETURNS:
+//|    The number of bytes.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotChunk::GetSize(void) const
+{
+    size_t size = sizeof(*this);
+
+    size += m_x.words.capacity() * sizeof(wxUint64);
+
+    for(size_t index = 0; index < m_columns.size(); index++)
+    {
+        size += sizeof(Column);
+        size += m_columns[index].stream.words.capacity() * sizeof(wxUint64);
+    }
+
+    size += m_summary.capacity() * sizeof(wxTrendPlotBucket);
+
+    return size;
+}
@@ -0,0 +1,178 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_chunk.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the class used to keep old
+//|    frames of a trend plot frame group in compressed form.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_CHUNK_H__
+#define __TREND_PLOT_CHUNK_H__
+
+#include <vector>
+#include <wx/defs.h>
+
+#include "wx/trend_plot_pyramid.h"
+
+// The number of frames compressed into each chunk
+#define TREND_PLOT_CHUNK_SIZE 1024
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotChunk
+//|
+//| DESCRIPTION:
+//|    This class compresses a run of consecutive frames the way time
+//|    series databases do. The x co-ordinates are stored as the delta of
+//|    the delta of their bit patterns, which is 0 for evenly spaced x
+//|    within a power of two, so they mostly take a single bit. Each y
+//|    co-ordinate is XORed with the one before it and only the bits that
+//|    changed are stored, which for a slowly varying signal is a few bits
+//|    per point. A chunk of a uniform group only stores the sample number
+//|    of its first frame instead of the x co-ordinates.
+//|
+//|    Frames can only be appended, and the chunk has to be decoded to read
+//|    them back. A summary of each column is kept up to date so that a
+//|    zoomed out plot doesn't have to decode the chunk at all.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotChunk
+{
+    public:
+        wxTrendPlotChunk(size_t columns);
+
+        // Create a chunk of a uniform group sampled every dt from x0,
+        // starting at the sample specified.
+        wxTrendPlotChunk(size_t columns, double x0, double dt, double first_sample);
+
+        // Append a frame. The x co-ordinate must be greater than that of
+        // the last frame and is ignored by a chunk of a uniform group,
+        // which takes the next sample.
+        void AddFrame(double x, const double* y);
+
+        // Stop adding frames and give back any spare storage
+        void Seal(void);
+
+        bool IsSealed(void) const
+        {
+            return m_sealed;
+        }
+
+        bool IsFull(void) const
+        {
+            return m_sealed || m_count >= TREND_PLOT_CHUNK_SIZE;
+        }
+
+        // Add a column that reads as 0 for every frame so far, or
+        // remove a column. The id changes so that any copy decoded
+        // from the chunk is no longer matched.
+        void AddColumn(void);
+        void RemoveColumn(size_t column);
+
+        size_t GetColumnCount(void) const
+        {
+            return m_columns.size();
+        }
+
+        size_t GetCount(void) const
+        {
+            return m_count;
+        }
+
+        bool IsUniform(void) const
+        {
+            return m_uniform;
+        }
+
+        // The sample number of the frame after the last frame of a
+        // chunk of a uniform group.
+        double GetNextSample(void) const
+        {
+            return m_first_sample + m_count;
+        }
+
+        // Identifies the contents of the chunk while it is alive
+        wxUint64 GetId(void) const
+        {
+            return m_id;
+        }
+
+        double GetFirstX(void) const
+        {
+            return m_first_x;
+        }
+
+        double GetLastX(void) const
+        {
+            return m_last_x;
+        }
+
+        // The first, last, minimum and maximum points of a column
+        const wxTrendPlotBucket& GetSummary(size_t column) const
+        {
+            return m_summary[column];
+        }
+
+        // Decode the points of a column
+        void Decode(size_t               column,
+                    std::vector<double>& x,
+                    std::vector<double>& y) const;
+
+        // The number of bytes used by the chunk
+        size_t GetSize(void) const;
+
+    private:
+        // A stream of bits written from the most significant end
+        // of each word.
+        struct Stream
+        {
+            std::vector<wxUint64> words;
+            size_t                bits;
+
+            void Write(wxUint64 value, int count);
+            wxUint64 Read(size_t& position, int count) const;
+        };
+
+        // The state of the compression of a column
+        struct Column
+        {
+            Stream   stream;
+            wxUint64 previous;
+            int      leading;
+            int      trailing;
+        };
+
+        void Initialise(size_t columns);
+        void EncodeX(double x);
+        void EncodeY(Column& column, double y);
+
+        static void Summarise(wxTrendPlotBucket& summary, double x, double y);
+        static wxUint64 NextId(void);
+
+        bool   m_uniform;
+        double m_x0;
+        double m_dt;
+        double m_first_sample;
+
+        size_t   m_count;
+        bool     m_sealed;
+        wxUint64 m_id;
+        double   m_first_x;
+        double   m_last_x;
+
+        // The x co-ordinates of a chunk that isn't uniform
+        Stream   m_x;
+        wxUint64 m_previous_x;
+        wxUint64 m_previous_delta;
+
+        std::vector<Column>            m_columns;
+        std::vector<wxTrendPlotBucket> m_summary;
+};
+
+#endif // __TREND_PLOT_CHUNK_H__
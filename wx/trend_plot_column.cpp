@@ -0,0 +1,311 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_column.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the class used to store
+//|    the y co-ordinates of a trend plot data set.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <cmath>
+
+#include "wx/trend_plot_column.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotColumn()
+//|
+//| PARAMETERS:
+//|    capacity (I) - The number of y co-ordinates stored.
+//|    encoding (I) - How the y co-ordinates are stored.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the column class. An encoding with a
+//|    scale of 0 would lose every sample so a scale of 1 is used instead.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotColumn::wxTrendPlotColumn(size_t                     capacity,
+                                     const wxTrendPlotEncoding& encoding)
+        : m_pyramid(capacity),
+          m_encoding(encoding)
+{
+    switch(m_encoding.m_type)
+    {
+        case TREND_PLOT_SAMPLE_FLOAT:
+            m_floats.resize(capacity);
+            break;
+
+        case TREND_PLOT_SAMPLE_INT16:
+            if(m_encoding.m_scale == 0)
+            {
+                m_encoding.m_scale = 1.0;
+            }
+            m_int16s.resize(capacity);
+            break;
+
+        default:
+            m_encoding.m_type = TREND_PLOT_SAMPLE_DOUBLE;
+            m_doubles.resize(capacity);
+            break;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetSampleSize()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method returns the storage used by each y co-ordinate.
+//|
+//| RETURNS:
+//|    The number of bytes.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotColumn::GetSampleSize(void) const
+{
+    switch(m_encoding.m_type)
+    {
+        case TREND_PLOT_SAMPLE_FLOAT:
+            return sizeof(float);
+
+        case TREND_PLOT_SAMPLE_INT16:
+            return sizeof(wxInt16);
+
+        default:
+            return sizeof(double);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Move()
+//|
+//| PARAMETERS:
+//|    to   (I) - The slot to copy to.
+//|    from (I) - The slot to copy from.
+//|
+//| FUNCTION:
+//|    This method copies a stored y co-ordinate without converting it.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotColumn::Move(size_t to, size_t from)
+{
+    switch(m_encoding.m_type)
+    {
+        case TREND_PLOT_SAMPLE_FLOAT:
+            m_floats[to] = m_floats[from];
+            break;
+
+        case TREND_PLOT_SAMPLE_INT16:
+            m_int16s[to] = m_int16s[from];
+            break;
+
+        default:
+            m_doubles[to] = m_doubles[from];
+            break;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ResizeSamples()
+//|
+//| PARAMETERS:
+//|    samples  (IO) - The samples stored as a ring buffer.
+//|    capacity (I)  - The new number of slots.
+//|    head     (I)  - The slot of the oldest sample.
+//|    count    (I)  - The number of samples to keep.
+//|
+//| FUNCTION:
+//|    This function moves the samples of a ring buffer, in order, to the
+//|    start of new storage of a different size.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+template <class T>
+static void ResizeSamples(std::vector<T>& samples,
+                          size_t          capacity,
+                          size_t          head,
+                          size_t          count)
+{
+    std::vector<T> resized(capacity);
+
+    for(size_t index = 0; index < count; index++)
+    {
+        size_t slot = head + index;
+
+        if(slot >= samples.size())
+        {
+            slot -= samples.size();
+        }
+
+        resized[index] = samples[slot];
+    }
+
+    samples.swap(resized);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Resize()
+//|
+//| PARAMETERS:
+//|    capacity (I) - The new number of slots.
+//|    head     (I) - The slot of the oldest sample.
+//|    count    (I) - The number of samples to keep, which can't be more
+//|                   than the new number of slots.
+//|
+//| FUNCTION:
+//|    This method changes the number of y co-ordinates the column can
+//|    store. The samples kept are moved to the start of the new storage.
+//|    The pyramid is left to the frame group to rebuild.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotColumn::Resize(size_t capacity, size_t head, size_t count)
+{
+    switch(m_encoding.m_type)
+    {
+        case TREND_PLOT_SAMPLE_FLOAT:
+            ResizeSamples(m_floats, capacity, head, count);
+            break;
+
+        case TREND_PLOT_SAMPLE_INT16:
+            ResizeSamples(m_int16s, capacity, head, count);
+            break;
+
+        default:
+            ResizeSamples(m_doubles, capacity, head, count);
+            break;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Quantize()
+//|
+//| PARAMETERS:
+//|    y (I) - The y co-ordinate.
+//|
+//| FUNCTION:
+//|    This method works out the value a y co-ordinate reads back as once
+//|    it has been stored. The pyramid is fed these values so that its
+//|    buckets agree with the points it summarises.
+//|
+//| RETURNS:
+//|    The value.
+//|
+//+------------------------------------------------------------------------------
+double wxTrendPlotColumn::Quantize(double y) const
+{
+    switch(m_encoding.m_type)
+    {
+        case TREND_PLOT_SAMPLE_FLOAT:
+            return (float)y;
+
+        case TREND_PLOT_SAMPLE_INT16:
+            return FromInt16(ToInt16(y));
+
+        default:
+            return y;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ToInt16()
+//|
+//| PARAMETERS:
+//|    y (I) - The y co-ordinate.
+//|
+//| FUNCTION:
+//|    This method converts a y co-ordinate to the nearest 16 bit sample.
+//|    Values out of range are clamped to the largest or smallest sample.
+//|    NaN is stored as TREND_PLOT_INT16_GAP, which no value is clamped
+//|    to, so that it can be told apart and left out of the plot.
+//|
+//| RETURNS:
+//|    The sample.
+//|
+//+------------------------------------------------------------------------------
+wxInt16 wxTrendPlotColumn::ToInt16(double y) const
+{
+    double sample = floor(((y - m_encoding.m_offset) / m_encoding.m_scale) + 0.5);
+
+    if(sample != sample)
+    {
+        return TREND_PLOT_INT16_GAP;
+    }
+
+    if(sample > 32767)
+    {
+        return 32767;
+    }
+
+    if(sample < -32767)
+    {
+        return -32767;
+    }
+
+    return (wxInt16)sample;
+}
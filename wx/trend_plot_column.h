@@ -0,0 +1,185 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_column.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the class used to store the
+//|    y co-ordinates of a trend plot data set.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_COLUMN_H__
+#define __TREND_PLOT_COLUMN_H__
+
+#include <limits>
+#include <vector>
+#include <wx/defs.h>
+
+#include "wx/trend_plot_pyramid.h"
+
+// How the y co-ordinates of a data set are stored
+#define TREND_PLOT_SAMPLE_DOUBLE 0
+#define TREND_PLOT_SAMPLE_FLOAT  1
+#define TREND_PLOT_SAMPLE_INT16  2
+
+// The 16 bit sample that marks a gap in the data, which reads back as
+// NaN. Numbers are clamped to -32767 to 32767 so they never store as it.
+#define TREND_PLOT_INT16_GAP (-32767 - 1)
+
+
+//+------------------------------------------------------------------------------
+//|
+//| STRUCTURE:
+//|    wxTrendPlotEncoding
+//|
+//| DESCRIPTION:
+//|    This structure describes how the y co-ordinates of a data set are
+//|    stored. A 16 bit sample is read back as sample * scale + offset,
+//|    so a 12 bit ADC channel can be stored as its raw counts. NaN is
+//|    stored as TREND_PLOT_INT16_GAP so that gaps survive the encoding.
+//|
+//+------------------------------------------------------------------------------
+struct wxTrendPlotEncoding
+{
+    wxTrendPlotEncoding(int    type = TREND_PLOT_SAMPLE_DOUBLE,
+                        double scale = 1.0,
+                        double offset = 0.0)
+    {
+        m_type = type;
+        m_scale = scale;
+        m_offset = offset;
+    }
+
+    int    m_type;
+    double m_scale;
+    double m_offset;
+};
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotColumn
+//|
+//| DESCRIPTION:
+//|    This class holds the y co-ordinates of one data set of a frame group
+//|    in the encoding chosen for it, along with the pyramid summarising
+//|    them. Only the storage for the encoding in use is allocated.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotColumn
+{
+    public:
+        wxTrendPlotColumn(size_t capacity, const wxTrendPlotEncoding& encoding);
+
+        const wxTrendPlotEncoding& GetEncoding(void) const
+        {
+            return m_encoding;
+        }
+
+        // The number of bytes used to store each y co-ordinate
+        size_t GetSampleSize(void) const;
+
+        // Read the y co-ordinate stored in a slot
+        double Get(size_t slot) const
+        {
+            switch(m_encoding.m_type)
+            {
+                case TREND_PLOT_SAMPLE_FLOAT:
+                    return m_floats[slot];
+
+                case TREND_PLOT_SAMPLE_INT16:
+                    return FromInt16(m_int16s[slot]);
+
+                default:
+                    return m_doubles[slot];
+            }
+        }
+
+        // Store a y co-ordinate in a slot
+        void Set(size_t slot, double y)
+        {
+            switch(m_encoding.m_type)
+            {
+                case TREND_PLOT_SAMPLE_FLOAT:
+                    m_floats[slot] = (float)y;
+                    break;
+
+                case TREND_PLOT_SAMPLE_INT16:
+                    m_int16s[slot] = ToInt16(y);
+                    break;
+
+                default:
+                    m_doubles[slot] = y;
+                    break;
+            }
+        }
+
+        // Copy the y co-ordinate in one slot to another
+        void Move(size_t to, size_t from);
+
+        // Change the number of slots, moving count samples starting
+        // at slot head to the start of the new storage.
+        void Resize(size_t capacity, size_t head, size_t count);
+
+        // The value a y co-ordinate reads back as once it's stored
+        double Quantize(double y) const;
+
+        // The stored samples, for drawing without converting each one
+        // through Get(). Only the one for the encoding is filled in.
+        const double* GetDoubles(void) const
+        {
+            return m_doubles.empty() ? NULL : &m_doubles[0];
+        }
+
+        const float* GetFloats(void) const
+        {
+            return m_floats.empty() ? NULL : &m_floats[0];
+        }
+
+        const wxInt16* GetInt16s(void) const
+        {
+            return m_int16s.empty() ? NULL : &m_int16s[0];
+        }
+
+        // Whether a stored sample marks a gap in the data
+        static bool IsGap(double sample)
+        {
+            return sample != sample;
+        }
+
+        static bool IsGap(float sample)
+        {
+            return sample != sample;
+        }
+
+        static bool IsGap(wxInt16 sample)
+        {
+            return sample == TREND_PLOT_INT16_GAP;
+        }
+
+        wxTrendPlotPyramid m_pyramid;
+
+    private:
+        wxInt16 ToInt16(double y) const;
+
+        double FromInt16(wxInt16 sample) const
+        {
+            if(sample == TREND_PLOT_INT16_GAP)
+            {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+
+            return (sample * m_encoding.m_scale) + m_encoding.m_offset;
+        }
+
+        wxTrendPlotEncoding m_encoding;
+
+        std::vector<double>  m_doubles;
+        std::vector<float>   m_floats;
+        std::vector<wxInt16> m_int16s;
+};
+
+#endif // __TREND_PLOT_COLUMN_H__
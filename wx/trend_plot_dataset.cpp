@@ -0,0 +1,241 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_dataset.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the data set class used to
+//|    store the points plotted by the trend plot.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include "wx/trend_plot_dataset.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotDataset()
+//|
+//| PARAMETERS:
+//|    capacity (I) - The maximum number of points stored by the data set.
+//|    encoding (I) - How the y co-ordinates are stored.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for a data set with a frame group of its
+//|    own. The storage for the points is allocated up front so that
+//|    adding points never has to allocate memory.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotDataset::wxTrendPlotDataset(size_t                     capacity,
+                                       const wxTrendPlotEncoding& encoding)
+        : m_group(new wxTrendPlotFrameGroup(capacity))
+{
+    m_column = m_group->AddColumn(encoding);
+    m_delete_menu_id = 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotDataset()
+//|
+//| PARAMETERS:
+//|    capacity (I) - The maximum number of points stored by the data set.
+//|    x0       (I) - The x co-ordinate of sample 0.
+//|    dt       (I) - The distance between samples.
+//|    encoding (I) - How the y co-ordinates are stored.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for a data set that is sampled at a fixed
+//|    rate, so the x co-ordinate of each point is implied by its index.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotDataset::wxTrendPlotDataset(size_t                     capacity,
+                                       double                     x0,
+                                       double                     dt,
+                                       const wxTrendPlotEncoding& encoding)
+        : m_group(new wxTrendPlotFrameGroup(capacity, x0, dt))
+{
+    m_column = m_group->AddColumn(encoding);
+    m_delete_menu_id = 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotDataset()
+//|
+//| PARAMETERS:
+//|    group    (I) - The frame group to store the points in.
+//|    encoding (I) - How the y co-ordinates are stored.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for a data set that shares a frame group
+//|    with other data sets.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotDataset::wxTrendPlotDataset(const wxTrendPlotFrameGroupPtr& group,
+                                       const wxTrendPlotEncoding&      encoding)
+        : m_group(group)
+{
+    m_column = m_group->AddColumn(encoding);
+    m_delete_menu_id = 0;
+}
+
+
+wxTrendPlotDataset::~wxTrendPlotDataset(void)
+{
+    m_group->RemoveColumn(m_column);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddPoint()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the point.
+//|    y (I) - The y co-ordinate of the point.
+//|
+//| FUNCTION:
+//|    This method is called to add a point to the data set. If the data
+//|    set is full the oldest point is discarded to make room for it.
+//|
+//| RETURNS:
+//|    false if the data set shares its group, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotDataset::AddPoint(double x, double y)
+{
+    if(IsShared())
+    {
+        return false;
+    }
+
+    m_group->AddFrame(x, &y);
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddPoints()
+//|
+//| PARAMETERS:
+//|    x     (I) - The x co-ordinates of the points.
+//|    y     (I) - The y co-ordinates of the points.
+//|    count (I) - The number of points.
+//|
+//| FUNCTION:
+//|    This method is called to add a block of points to the data set.
+//|    A group with a single column stores a frame as one y co-ordinate
+//|    so the points are passed straight through as frames.
+//|
+//| RETURNS:
+//|    false if the data set shares its group, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotDataset::AddPoints(const double* x, const double* y, size_t count)
+{
+    if(IsShared())
+    {
+        return false;
+    }
+
+    m_group->AddFrames(x, y, count);
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddSamples()
+//|
+//| PARAMETERS:
+//|    y     (I) - The y co-ordinates of the samples.
+//|    count (I) - The number of samples.
+//|
+//| FUNCTION:
+//|    This method is called to add the next samples to a data set that
+//|    is sampled at a fixed rate. Only the y co-ordinates are stored.
+//|
+//| RETURNS:
+//|    false if the data set isn't sampled at a fixed rate or shares its
+//|    group, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotDataset::AddSamples(const double* y, size_t count)
+{
+    if(IsShared() || !m_group->IsUniform())
+    {
+        return false;
+    }
+
+    m_group->AddSamples(y, count);
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Clear()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called to remove all the points from the data set.
+//|    The points of the other data sets sharing the group go too.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotDataset::Clear(void)
+{
+    m_group->Clear();
+}
@@ -1,19 +1,170 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_dataset.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the data set class used to
+//|    store the points plotted by the trend plot.
+//|
+//+------------------------------------------------------------------------------
 #ifndef __TREND_PLOT_DATASET_H__
 #define __TREND_PLOT_DATASET_H__
 
 #include <string>
-#include <map>
+#include <vector>
 #include <wx/colour.h>
 
+#include "wx/trend_plot_frame_group.h"
+#include "wx/trend_plot_queue.h"
+#include "wx/trend_plot_range.h"
+
+// The default number of points retained by a data set before
+// the oldest points start being overwritten.
+#define TREND_PLOT_DEFAULT_CAPACITY 65536
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotDataset
+//|
+//| DESCRIPTION:
+//|    This class describes a single trend line. Its points are stored as
+//|    a column of a frame group, which keeps them sorted by x in a ring
+//|    buffer of fixed capacity along with a pyramid of min/max buckets
+//|    for drawing zoomed out plots. A data set normally has a group of
+//|    its own, but data sets that are sampled together can share one
+//|    group so that the x co-ordinates are only stored once, and a data
+//|    set sampled at a fixed rate doesn't need to store them at all.
+//|
+//+------------------------------------------------------------------------------
 class wxTrendPlotDataset
 {
     public:
+        // Create a data set with a frame group of its own
+        wxTrendPlotDataset(size_t                     capacity = TREND_PLOT_DEFAULT_CAPACITY,
+                           const wxTrendPlotEncoding& encoding = wxTrendPlotEncoding());
+
+        // Create a data set sampled every dt from x0. Only the y
+        // co-ordinates of its points are stored.
+        wxTrendPlotDataset(size_t                     capacity,
+                           double                     x0,
+                           double                     dt,
+                           const wxTrendPlotEncoding& encoding = wxTrendPlotEncoding());
+
+        // Create a data set as another column of a frame group
+        wxTrendPlotDataset(const wxTrendPlotFrameGroupPtr& group,
+                           const wxTrendPlotEncoding&      encoding = wxTrendPlotEncoding());
+
+        ~wxTrendPlotDataset(void);
+
+        // Add a point to the data set. Points newer than the last
+        // point are appended in constant time, anything else falls
+        // back to a sorted insert. Returns false if the data set
+        // shares its group, whose points are added a frame at a
+        // time through the group.
+        bool AddPoint(double x, double y);
+
+        // Add a block of points to the data set. The leading run of
+        // points that are newer than the last point is copied in with
+        // a single capacity check.
+        bool AddPoints(const double* x, const double* y, size_t count);
+
+        // Add the next samples to a data set created with a sample
+        // interval. Returns false for any other data set.
+        bool AddSamples(const double* y, size_t count);
+
+        // Remove all the points from the data set
+        void Clear(void);
+
+        // Whether other data sets store their points in the
+        // same frame group.
+        bool IsShared(void) const
+        {
+            return m_group->GetColumnCount() > 1;
+        }
+
+        wxTrendPlotFrameGroup& GetGroup(void) const
+        {
+            return *m_group;
+        }
+
+        const wxTrendPlotColumn& GetColumn(void) const
+        {
+            return *m_column;
+        }
+
+        size_t GetCount(void) const
+        {
+            return m_group->GetCount();
+        }
+
+        size_t GetCapacity(void) const
+        {
+            return m_group->GetCapacity();
+        }
+
+        // Access the points in order, index 0 being the oldest point.
+        double GetX(size_t index) const
+        {
+            return m_group->GetX(index);
+        }
+
+        double GetY(size_t index) const
+        {
+            return m_group->GetY(m_column, index);
+        }
+
+        // Find the points needed to draw the range [start_x, end_x]
+        // including one neighbouring point either side of it.
+        bool FindRange(double  start_x,
+                       double  end_x,
+                       size_t& first,
+                       size_t& last) const
+        {
+            return m_group->FindRange(start_x, end_x, first, last);
+        }
+
+        // Access the min/max summary of the points
+        const wxTrendPlotPyramid& GetPyramid(void) const
+        {
+            return m_column->m_pyramid;
+        }
+
+        // Find the buckets of a level of the pyramid needed to
+        // draw the range [start_x, end_x].
+        bool FindBuckets(int     level,
+                         double  start_x,
+                         double  end_x,
+                         size_t& first,
+                         size_t& last) const
+        {
+            return m_group->FindBuckets(m_column, level, start_x, end_x, first, last);
+        }
+
         wxString                 m_label;
-        std::map<double, double> m_points;
         wxColour                 m_color;
-        
+
         int m_delete_menu_id;
+
+        // Points posted to the data set from other threads. The
+        // data sets of a frame group share a queue of frames.
+        wxTrendPlotQueuePtr m_queue;
+
+        // The range of the points that were visible when the plot
+        // was last drawn, used to scale the y axis.
+        wxTrendPlotRange m_range;
+
+    private:
+        // The column belongs to the group so data sets can't be copied
+        wxTrendPlotDataset(const wxTrendPlotDataset&);
+        wxTrendPlotDataset& operator=(const wxTrendPlotDataset&);
+
+        wxTrendPlotFrameGroupPtr m_group;
+        wxTrendPlotColumn*       m_column;
 };
 
 #endif // __TREND_PLOT_DATASET_H__
-
@@ -0,0 +1,192 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_dataset_map.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the class used to look up
+//|    the data sets of a trend plot by handle.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include "wx/trend_plot_dataset_map.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotDatasetMap()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the data set map class.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotDatasetMap::wxTrendPlotDatasetMap(void)
+{
+    m_first = TREND_PLOT_INVALID_SLOT;
+    m_last = TREND_PLOT_INVALID_SLOT;
+    m_free = TREND_PLOT_INVALID_SLOT;
+    m_count = 0;
+}
+
+
+wxTrendPlotDatasetMap::~wxTrendPlotDatasetMap(void)
+{
+    for(size_t index = 0; index < m_slots.size(); index++)
+    {
+        delete m_slots[index].data;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Add()
+//|
+//| PARAMETERS:
+//|    data (I) - The data set to add. The map deletes it when it is
+//|               removed.
+//|
+//| FUNCTION:
+//|    This method stores a data set in a free slot, or a new one if there
+//|    aren't any, and links it onto the end of the list of data sets.
+//|
+//| RETURNS:
+//|    The handle of the data set.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotHandle wxTrendPlotDatasetMap::Add(wxTrendPlotDataset* data)
+{
+    size_t index = m_free;
+
+    if(index != TREND_PLOT_INVALID_SLOT)
+    {
+        m_free = m_slots[index].next;
+    }
+    else
+    {
+        Slot slot;
+        slot.data = NULL;
+        slot.generation = 0;
+
+        index = m_slots.size();
+        m_slots.push_back(slot);
+    }
+
+    Slot& slot = m_slots[index];
+
+    slot.data = data;
+    slot.previous = m_last;
+    slot.next = TREND_PLOT_INVALID_SLOT;
+
+    if(m_last != TREND_PLOT_INVALID_SLOT)
+    {
+        m_slots[m_last].next = index;
+    }
+    else
+    {
+        m_first = index;
+    }
+
+    m_last = index;
+    m_count++;
+
+    return wxTrendPlotHandle(index, slot.generation);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Remove()
+//|
+//| PARAMETERS:
+//|    handle (I) - The handle of the data set.
+//|
+//| FUNCTION:
+//|    This method unlinks a data set from the list, deletes it and puts
+//|    its slot on the free list. The generation of the slot is bumped so
+//|    that the handle no longer matches.
+//|
+//| RETURNS:
+//|    false if the handle is stale, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotDatasetMap::Remove(wxTrendPlotHandle handle)
+{
+    if(Find(handle) == NULL)
+    {
+        return false;
+    }
+
+    size_t index = handle.m_slot;
+    Slot& slot = m_slots[index];
+
+    if(slot.previous != TREND_PLOT_INVALID_SLOT)
+    {
+        m_slots[slot.previous].next = slot.next;
+    }
+    else
+    {
+        m_first = slot.next;
+    }
+
+    if(slot.next != TREND_PLOT_INVALID_SLOT)
+    {
+        m_slots[slot.next].previous = slot.previous;
+    }
+    else
+    {
+        m_last = slot.previous;
+    }
+
+    delete slot.data;
+
+    slot.data = NULL;
+    slot.generation++;
+    slot.previous = TREND_PLOT_INVALID_SLOT;
+    slot.next = m_free;
+
+    m_free = index;
+    m_count--;
+
+    return true;
+}
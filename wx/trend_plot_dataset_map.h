@@ -0,0 +1,163 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_dataset_map.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the class used to look up the
+//|    data sets of a trend plot by handle.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_DATASET_MAP_H__
+#define __TREND_PLOT_DATASET_MAP_H__
+
+#include <vector>
+
+#include "wx/trend_plot_dataset.h"
+
+// Marks the end of the list of data sets and an unused handle
+#define TREND_PLOT_INVALID_SLOT ((size_t)-1)
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotHandle
+//|
+//| DESCRIPTION:
+//|    This class identifies a data set of a trend plot. The generation
+//|    is bumped each time a slot is re-used so a handle to a data set
+//|    that has been removed never finds the data set that replaced it.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotHandle
+{
+    public:
+        wxTrendPlotHandle(void)
+        {
+            m_slot = TREND_PLOT_INVALID_SLOT;
+            m_generation = 0;
+        }
+
+        wxTrendPlotHandle(size_t slot, unsigned int generation)
+        {
+            m_slot = slot;
+            m_generation = generation;
+        }
+
+        bool IsOk(void) const
+        {
+            return m_slot != TREND_PLOT_INVALID_SLOT;
+        }
+
+        bool operator==(const wxTrendPlotHandle& other) const
+        {
+            return m_slot == other.m_slot && m_generation == other.m_generation;
+        }
+
+        bool operator!=(const wxTrendPlotHandle& other) const
+        {
+            return !(*this == other);
+        }
+
+        size_t       m_slot;
+        unsigned int m_generation;
+};
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotDatasetMap
+//|
+//| DESCRIPTION:
+//|    This class owns the data sets of a trend plot. Each data set lives
+//|    in a slot of a table and is found from its handle in constant time.
+//|    The slots in use are linked together in the order the data sets
+//|    were added, which is the order they are drawn in, and free slots
+//|    are kept on a free list. Adding or removing a data set never moves
+//|    the others so their handles stay valid.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotDatasetMap
+{
+    public:
+        wxTrendPlotDatasetMap(void);
+
+        ~wxTrendPlotDatasetMap(void);
+
+        // Add a data set, which the map takes ownership of
+        wxTrendPlotHandle Add(wxTrendPlotDataset* data);
+
+        // Remove and delete a data set
+        bool Remove(wxTrendPlotHandle handle);
+
+        // Find a data set. Returns NULL if the handle is stale.
+        wxTrendPlotDataset* Find(wxTrendPlotHandle handle) const
+        {
+            if(handle.m_slot >= m_slots.size())
+            {
+                return NULL;
+            }
+
+            const Slot& slot = m_slots[handle.m_slot];
+
+            if(slot.generation != handle.m_generation)
+            {
+                return NULL;
+            }
+
+            return slot.data;
+        }
+
+        size_t GetCount(void) const
+        {
+            return m_count;
+        }
+
+        // Walk the slots of the data sets in the order they were
+        // added. GetNext() returns TREND_PLOT_INVALID_SLOT at the end.
+        size_t GetFirst(void) const
+        {
+            return m_first;
+        }
+
+        size_t GetNext(size_t slot) const
+        {
+            return m_slots[slot].next;
+        }
+
+        wxTrendPlotDataset& Get(size_t slot) const
+        {
+            return *m_slots[slot].data;
+        }
+
+        wxTrendPlotHandle GetHandle(size_t slot) const
+        {
+            return wxTrendPlotHandle(slot, m_slots[slot].generation);
+        }
+
+    private:
+        struct Slot
+        {
+            // NULL when the slot is free
+            wxTrendPlotDataset* data;
+            unsigned int        generation;
+
+            // The neighbouring slots in use, or the next free
+            // slot if this one is free.
+            size_t previous;
+            size_t next;
+        };
+
+        std::vector<Slot> m_slots;
+
+        size_t m_first;
+        size_t m_last;
+        size_t m_free;
+        size_t m_count;
+};
+
+#endif // __TREND_PLOT_DATASET_MAP_H__
@@ -0,0 +1,221 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_decimator.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of a class used to reduce the
+//|    number of points drawn by the trend plot.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include "wx/trend_plot_decimator.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotDecimator()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the decimator class.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotDecimator::wxTrendPlotDecimator(void)
+{
+    Begin();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Begin()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called to start decimating a new line. The memory
+//|    used by the previous line is kept for re-use.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotDecimator::Begin(void)
+{
+    m_points.clear();
+
+    m_column_x = 0;
+    m_first_y = 0;
+    m_min_y = 0;
+    m_max_y = 0;
+    m_last_y = 0;
+    m_min_index = 0;
+    m_max_index = 0;
+    m_column_count = 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    End()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called once all the points of the line have been
+//|    added.
+//|
+//| RETURNS:
+//|    The decimated points in the order they should be drawn.
+//|
+//+------------------------------------------------------------------------------
+const std::vector<wxPoint>& wxTrendPlotDecimator::End(void)
+{
+    FlushColumn();
+    m_column_count = 0;
+
+    return m_points;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddGap()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called where there is a gap in the data. The pixel
+//|    column so far is output and followed by a point that breaks the
+//|    line. A gap at the start of the line or straight after another gap
+//|    has nothing to break so it is left out.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotDecimator::AddGap(void)
+{
+    FlushColumn();
+    m_column_count = 0;
+
+    if(!m_points.empty() && m_points.back().y != TREND_PLOT_GAP_Y)
+    {
+        m_points.push_back(wxPoint(m_column_x, TREND_PLOT_GAP_Y));
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FlushColumn()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method outputs the points of the current pixel column. The
+//|    minimum and maximum are output in the order they were added so
+//|    that the line still moves forwards through the points.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotDecimator::FlushColumn(void)
+{
+    if(m_column_count == 0)
+    {
+        return;
+    }
+
+    Emit(m_column_x, m_first_y);
+
+    if(m_min_index < m_max_index)
+    {
+        Emit(m_column_x, m_min_y);
+        Emit(m_column_x, m_max_y);
+    }
+    else
+    {
+        Emit(m_column_x, m_max_y);
+        Emit(m_column_x, m_min_y);
+    }
+
+    Emit(m_column_x, m_last_y);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Emit()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the point.
+//|    y (I) - The y co-ordinate of the point.
+//|
+//| FUNCTION:
+//|    This method adds a point to the decimated line unless it is the
+//|    same as the previous point.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotDecimator::Emit(int x, int y)
+{
+    if(!m_points.empty() &&
+       m_points.back().x == x &&
+       m_points.back().y == y)
+    {
+        return;
+    }
+
+    m_points.push_back(wxPoint(x, y));
+}
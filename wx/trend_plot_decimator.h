@@ -0,0 +1,114 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_decimator.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of a class used to reduce the
+//|    number of points drawn by the trend plot.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_DECIMATOR_H__
+#define __TREND_PLOT_DECIMATOR_H__
+
+#include <climits>
+#include <vector>
+#include <wx/gdicmn.h>
+
+// The y co-ordinate of the point put in a decimated line where there
+// is a gap in the data. The points either side of it aren't joined.
+#define TREND_PLOT_GAP_Y INT_MIN
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotDecimator
+//|
+//| DESCRIPTION:
+//|    This class reduces a line in screen co-ordinates down to at most
+//|    four points per pixel column: the first, minimum, maximum and last
+//|    point falling in the column. Drawing the reduced line touches the
+//|    same pixels as drawing every point, but the amount of work is
+//|    bounded by the width of the plot rather than the number of points.
+//|
+//|    A y that isn't a number is a gap in the data. It ends the pixel
+//|    column and puts a point with a y of TREND_PLOT_GAP_Y in the line.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotDecimator
+{
+    public:
+        wxTrendPlotDecimator(void);
+
+        // Start decimating a new line
+        void Begin(void);
+
+        // Add the next point of the line. Points must be
+        // added in order of increasing x.
+        void AddPoint(int x, double y)
+        {
+            if(y != y)
+            {
+                AddGap();
+                return;
+            }
+
+            int screen_y = (int)y;
+
+            if(m_column_count != 0 && x == m_column_x)
+            {
+                if(screen_y < m_min_y)
+                {
+                    m_min_y = screen_y;
+                    m_min_index = m_column_count;
+                }
+                else if(screen_y > m_max_y)
+                {
+                    m_max_y = screen_y;
+                    m_max_index = m_column_count;
+                }
+
+                m_last_y = screen_y;
+                m_column_count++;
+                return;
+            }
+
+            FlushColumn();
+
+            m_column_x = x;
+            m_first_y = screen_y;
+            m_min_y = screen_y;
+            m_max_y = screen_y;
+            m_last_y = screen_y;
+            m_min_index = 0;
+            m_max_index = 0;
+            m_column_count = 1;
+        }
+
+        // Break the line where there is a gap in the data
+        void AddGap(void);
+
+        // Finish the line and return the decimated points
+        const std::vector<wxPoint>& End(void);
+
+    private:
+        void FlushColumn(void);
+        void Emit(int x, int y);
+
+        std::vector<wxPoint> m_points;
+
+        // The state of the pixel column currently being reduced
+        int    m_column_x;
+        int    m_first_y;
+        int    m_min_y;
+        int    m_max_y;
+        int    m_last_y;
+        size_t m_min_index;
+        size_t m_max_index;
+        size_t m_column_count;
+};
+
+#endif // __TREND_PLOT_DECIMATOR_H__
@@ -0,0 +1,771 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_file.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the class used to record
+//|    the frames of a trend plot frame group in a memory mapped file.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <cstring>
+
+#if defined(__WXMSW__)
+    #include <windows.h>
+    #include <winioctl.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "wx/trend_plot_file.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotFile()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the trend plot file class. The file
+//|    isn't opened until Open() is called.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotFile::wxTrendPlotFile(void)
+{
+    m_base = NULL;
+    m_size = 0;
+    m_header = NULL;
+    m_x = NULL;
+
+#if defined(__WXMSW__)
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = NULL;
+#else
+    m_file = -1;
+#endif
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ~wxTrendPlotFile()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the destructor for the trend plot file class.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotFile::~wxTrendPlotFile(void)
+{
+    Close();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Open()
+//|
+//| PARAMETERS:
+//|    path     (I) - The path of the file.
+//|    columns  (I) - The number of y co-ordinates in each frame.
+//|    capacity (I) - The number of frames a new file can hold.
+//|
+//| FUNCTION:
+//|    This method opens a file, creating it if it doesn't exist, and
+//|    works out the buckets being filled from what has been stored.
+//|
+//| RETURNS:
+//|    True if the file was opened, false if it couldn't be or it was
+//|    written with a different layout.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotFile::Open(const wxString& path, size_t columns, size_t capacity)
+{
+    Close();
+
+    if(columns == 0 || capacity == 0)
+    {
+        return false;
+    }
+
+    if(!Map(path, columns, capacity))
+    {
+        Unmap();
+        return false;
+    }
+
+    RestoreOpenBuckets();
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Close()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method flushes and closes the file.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFile::Close(void)
+{
+    Flush();
+    Unmap();
+
+    m_y.clear();
+    m_sizes.clear();
+    m_buckets.clear();
+    m_open.clear();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Map()
+//|
+//| PARAMETERS:
+//|    path     (I) - The path of the file.
+//|    columns  (I) - The number of y co-ordinates in each frame.
+//|    capacity (I) - The number of frames a new file can hold.
+//|
+//| FUNCTION:
+//|    This method opens the file and maps it into memory. A new file is
+//|    made sparse, extended to its full size and given a header, an
+//|    existing file is checked against the layout asked for.
+//|
+//| RETURNS:
+//|    True if the file was mapped.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotFile::Map(const wxString& path, size_t columns, size_t capacity)
+{
+    Header header;
+    bool   create;
+    size_t size;
+
+#if defined(__WXMSW__)
+    m_file = CreateFile(path.fn_str(),
+                        GENERIC_READ | GENERIC_WRITE,
+                        FILE_SHARE_READ,
+                        NULL,
+                        OPEN_ALWAYS,
+                        FILE_ATTRIBUTE_NORMAL,
+                        NULL);
+    if(m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER length;
+    if(!GetFileSizeEx(m_file, &length))
+    {
+        return false;
+    }
+
+    create = (length.QuadPart == 0);
+
+    if(!create)
+    {
+        DWORD read = 0;
+        if(!ReadFile(m_file, &header, sizeof(header), &read, NULL) || read != sizeof(header))
+        {
+            return false;
+        }
+    }
+#else
+    m_file = open(path.fn_str(), O_RDWR | O_CREAT, 0644);
+    if(m_file < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if(fstat(m_file, &info) != 0)
+    {
+        return false;
+    }
+
+    create = (info.st_size == 0);
+
+    if(!create)
+    {
+        if(pread(m_file, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+        {
+            return false;
+        }
+    }
+#endif
+
+    if(!create)
+    {
+        // Never write over a file that wasn't written with this layout
+        if(memcmp(header.magic, TREND_PLOT_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+           header.version != TREND_PLOT_FILE_VERSION ||
+           header.columns != columns ||
+           header.capacity == 0 ||
+           header.count > header.capacity)
+        {
+            return false;
+        }
+
+        capacity = (size_t)header.capacity;
+    }
+
+    size = Layout(columns, capacity);
+
+#if defined(__WXMSW__)
+    if(!create && (wxUint64)length.QuadPart < size)
+    {
+        return false;
+    }
+
+    // Creating the mapping extends a new file to its full size, which
+    // NTFS only leaves unallocated if the file is marked as sparse.
+    // Other file systems refuse, and the whole file is allocated.
+    if(create)
+    {
+        DWORD returned = 0;
+
+        DeviceIoControl(m_file, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &returned, NULL);
+    }
+
+    m_mapping = CreateFileMapping(m_file,
+                                  NULL,
+                                  PAGE_READWRITE,
+                                  (DWORD)((wxUint64)size >> 32),
+                                  (DWORD)size,
+                                  NULL);
+    if(m_mapping == NULL)
+    {
+        return false;
+    }
+
+    m_base = MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, size);
+#else
+    if(create)
+    {
+        if(ftruncate(m_file, size) != 0)
+        {
+            return false;
+        }
+    }
+    else if((wxUint64)info.st_size < size)
+    {
+        return false;
+    }
+
+    m_base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+    if(m_base == MAP_FAILED)
+    {
+        m_base = NULL;
+    }
+#endif
+
+    if(m_base == NULL)
+    {
+        return false;
+    }
+
+    m_size = size;
+    m_header = (Header*)m_base;
+
+    if(create)
+    {
+        memcpy(m_header->magic, TREND_PLOT_FILE_MAGIC, sizeof(m_header->magic));
+        m_header->version = TREND_PLOT_FILE_VERSION;
+        m_header->columns = columns;
+        m_header->capacity = capacity;
+        m_header->count = 0;
+    }
+
+    Layout(columns, capacity);
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Unmap()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method unmaps and closes the file.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFile::Unmap(void)
+{
+#if defined(__WXMSW__)
+    if(m_base != NULL)
+    {
+        UnmapViewOfFile(m_base);
+    }
+
+    if(m_mapping != NULL)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+
+    if(m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if(m_base != NULL)
+    {
+        munmap(m_base, m_size);
+    }
+
+    if(m_file >= 0)
+    {
+        close(m_file);
+        m_file = -1;
+    }
+#endif
+
+    m_base = NULL;
+    m_size = 0;
+    m_header = NULL;
+    m_x = NULL;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Layout()
+//|
+//| PARAMETERS:
+//|    columns  (I) - The number of y co-ordinates in each frame.
+//|    capacity (I) - The number of frames the file can hold.
+//|
+//| FUNCTION:
+//|    This method works out where each part of the file goes. The levels
+//|    of the pyramids match those of wxTrendPlotPyramid. When the file is
+//|    mapped the pointers to each part are set up as well.
+//|
+//| RETURNS:
+//|    The size of the file in bytes.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotFile::Layout(size_t columns, size_t capacity)
+{
+    char*  base = (char*)m_base;
+    size_t offset = Align(sizeof(Header));
+
+    m_sizes.clear();
+
+    for(size_t size = TREND_PLOT_PYRAMID_BASE_SIZE; size <= capacity; size *= 2)
+    {
+        m_sizes.push_back(size);
+    }
+
+    m_x = NULL;
+    m_y.assign(columns, NULL);
+    m_buckets.assign(columns, std::vector<wxTrendPlotBucket*>(m_sizes.size(), NULL));
+
+    if(base != NULL)
+    {
+        m_x = (double*)(base + offset);
+    }
+    offset += Align(capacity * sizeof(double));
+
+    for(size_t column = 0; column < columns; column++)
+    {
+        if(base != NULL)
+        {
+            m_y[column] = (double*)(base + offset);
+        }
+        offset += Align(capacity * sizeof(double));
+    }
+
+    for(size_t column = 0; column < columns; column++)
+    {
+        for(size_t level = 0; level < m_sizes.size(); level++)
+        {
+            if(base != NULL)
+            {
+                m_buckets[column][level] = (wxTrendPlotBucket*)(base + offset);
+            }
+            offset += Align((capacity / m_sizes[level]) * sizeof(wxTrendPlotBucket));
+        }
+    }
+
+    return offset;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    RestoreOpenBuckets()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method works out the bucket being filled at each level of the
+//|    pyramids. At the finest level it covers the frames after the last
+//|    closed bucket, and at each level above it covers the closed buckets
+//|    of the level below that haven't been merged up yet.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFile::RestoreOpenBuckets(void)
+{
+    size_t count = GetCount();
+
+    wxTrendPlotBucket empty;
+    memset(&empty, 0, sizeof(empty));
+
+    m_open.assign(m_y.size(), std::vector<wxTrendPlotBucket>(m_sizes.size(), empty));
+
+    for(size_t column = 0; column < m_y.size(); column++)
+    {
+        for(size_t level = 0; level < m_sizes.size(); level++)
+        {
+            wxTrendPlotBucket& open = m_open[column][level];
+            size_t start = (count / m_sizes[level]) * m_sizes[level];
+
+            if(level == 0)
+            {
+                for(size_t index = start; index < count; index++)
+                {
+                    wxTrendPlotBucket point;
+                    point.first_x = point.last_x = point.min_x = point.max_x = m_x[index];
+                    point.first_y = point.last_y = point.min_y = point.max_y = m_y[column][index];
+                    point.count = 1;
+
+                    wxTrendPlotPyramid::Merge(open, point);
+                }
+
+                continue;
+            }
+
+            size_t below = m_sizes[level - 1];
+
+            for(size_t index = start / below; index < count / below; index++)
+            {
+                wxTrendPlotPyramid::Merge(open, m_buckets[column][level - 1][index]);
+            }
+        }
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddFrame()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the frame.
+//|    y (I) - The y co-ordinate of each column.
+//|
+//| FUNCTION:
+//|    This method appends a frame to the file and adds it to the pyramid
+//|    of each column, writing out any bucket that fills up. The count in
+//|    the header is updated last so that a frame is only ever read back
+//|    once it has been written in full.
+//|
+//| RETURNS:
+//|    True if the frame was stored.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotFile::AddFrame(double x, const double* y)
+{
+    if(!IsOpen())
+    {
+        return false;
+    }
+
+    size_t count = GetCount();
+
+    if(count >= GetCapacity() || (count != 0 && !(x > m_x[count - 1])))
+    {
+        return false;
+    }
+
+    m_x[count] = x;
+
+    for(size_t column = 0; column < m_y.size(); column++)
+    {
+        m_y[column][count] = y[column];
+
+        wxTrendPlotBucket bucket;
+        bucket.first_x = bucket.last_x = bucket.min_x = bucket.max_x = x;
+        bucket.first_y = bucket.last_y = bucket.min_y = bucket.max_y = y[column];
+        bucket.count = 1;
+
+        for(size_t level = 0; level < m_sizes.size(); level++)
+        {
+            wxTrendPlotBucket& open = m_open[column][level];
+
+            wxTrendPlotPyramid::Merge(open, bucket);
+
+            if(open.count < m_sizes[level])
+            {
+                break;
+            }
+
+            m_buckets[column][level][(count + 1) / m_sizes[level] - 1] = open;
+
+            bucket = open;
+            open.count = 0;
+        }
+    }
+
+    m_header->count = count + 1;
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Flush()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method asks for the changes to the mapping to be written to
+//|    disk without waiting for them.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFile::Flush(void)
+{
+    if(!IsOpen())
+    {
+        return;
+    }
+
+#if defined(__WXMSW__)
+    FlushViewOfFile(m_base, 0);
+#else
+    msync(m_base, m_size, MS_ASYNC);
+#endif
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    LowerBound()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate to search for.
+//|
+//| FUNCTION:
+//|    This method finds the first frame with an x co-ordinate that is
+//|    not less than the x specified.
+//|
+//| RETURNS:
+//|    The index of the frame or the count if there isn't one.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotFile::LowerBound(double x) const
+{
+    size_t low = 0;
+    size_t high = GetCount();
+
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if(m_x[middle] < x)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    UpperBound()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate to search for.
+//|
+//| FUNCTION:
+//|    This method finds the first frame with an x co-ordinate that is
+//|    greater than the x specified.
+//|
+//| RETURNS:
+//|    The index of the frame or the count if there isn't one.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotFile::UpperBound(double x) const
+{
+    size_t low = 0;
+    size_t high = GetCount();
+
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if(m_x[middle] <= x)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FindRange()
+//|
+//| PARAMETERS:
+//|    start_x (I) - The start of the visible range.
+//|    end_x   (I) - The end of the visible range.
+//|    first   (O) - The index of the first frame to draw.
+//|    last    (O) - One past the index of the last frame to draw.
+//|
+//| FUNCTION:
+//|    This method finds the frames that fall inside the visible range,
+//|    plus the frame either side so that the lines leaving the edges of
+//|    the plot are drawn.
+//|
+//| RETURNS:
+//|    True if there are any frames to draw.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotFile::FindRange(double  start_x,
+                                double  end_x,
+                                size_t& first,
+                                size_t& last) const
+{
+    first = UpperBound(start_x);
+
+    if(first != 0)
+    {
+        first--;
+    }
+
+    last = LowerBound(end_x);
+
+    if(last != GetCount())
+    {
+        last++;
+    }
+
+    return first < last;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetLevel()
+//|
+//| PARAMETERS:
+//|    points_per_bucket (I) - The most frames a bucket may summarise.
+//|
+//| FUNCTION:
+//|    This method finds the coarsest level of the pyramids that is still
+//|    fine enough to draw from.
+//|
+//| RETURNS:
+//|    The level or -1 if the frames should be drawn directly.
+//|
+//+------------------------------------------------------------------------------
+int wxTrendPlotFile::GetLevel(size_t points_per_bucket) const
+{
+    int level = -1;
+
+    for(size_t index = 0; index < m_sizes.size(); index++)
+    {
+        if(m_sizes[index] > points_per_bucket)
+        {
+            break;
+        }
+
+        level = index;
+    }
+
+    return level;
+}
@@ -0,0 +1,182 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_file.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the class used to record the
+//|    frames of a trend plot frame group in a memory mapped file.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_FILE_H__
+#define __TREND_PLOT_FILE_H__
+
+#include <vector>
+#include <wx/defs.h>
+#include <wx/string.h>
+
+#include "wx/trend_plot_pyramid.h"
+
+// Identifies a trend plot file and the version of its layout
+#define TREND_PLOT_FILE_MAGIC   "wxTrendF"
+#define TREND_PLOT_FILE_VERSION 1
+
+// Each part of the file starts on a boundary of this many bytes
+#define TREND_PLOT_FILE_ALIGN 4096
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotFile
+//|
+//| DESCRIPTION:
+//|    This class records frames in an append-only file that is mapped
+//|    into memory. The file is laid out in columns: a header, the x
+//|    co-ordinates, the y co-ordinates of each column and then the closed
+//|    buckets of a min/max pyramid for each column. Every part is sized
+//|    for the capacity up front so that nothing moves as frames are
+//|    appended. The file is created sparse on file systems that support
+//|    it, such as NTFS and most Unix file systems, so disk space is only
+//|    used as it fills up. On others, such as FAT, the whole capacity is
+//|    allocated when the file is created.
+//|
+//|    Reading a frame or a bucket just touches the mapped memory, so only
+//|    the pages under the visible part of the plot are ever read from
+//|    disk. Reopening a file only has to read the header and rebuild the
+//|    bucket being filled at each level of the pyramids.
+//|
+//|    The file is written in the byte order and layout of the machine, so
+//|    it can only be read back by a build for the same platform.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotFile
+{
+    public:
+        wxTrendPlotFile(void);
+
+        ~wxTrendPlotFile(void);
+
+        // Open a file, creating it if it doesn't exist. An existing file
+        // keeps the capacity it was created with but must have the same
+        // number of columns.
+        bool Open(const wxString& path, size_t columns, size_t capacity);
+
+        // Flush and close the file
+        void Close(void);
+
+        bool IsOpen(void) const
+        {
+            return m_base != NULL;
+        }
+
+        // Append a frame. It is refused if the x co-ordinate isn't
+        // greater than that of the last frame or the file is full.
+        bool AddFrame(double x, const double* y);
+
+        // Ask for the frames appended so far to be written to disk
+        void Flush(void);
+
+        size_t GetColumnCount(void) const
+        {
+            return m_y.size();
+        }
+
+        size_t GetCount(void) const
+        {
+            return IsOpen() ? (size_t)m_header->count : 0;
+        }
+
+        size_t GetCapacity(void) const
+        {
+            return IsOpen() ? (size_t)m_header->capacity : 0;
+        }
+
+        // Access the frames in order, index 0 being the oldest frame.
+        double GetX(size_t index) const
+        {
+            return m_x[index];
+        }
+
+        double GetY(size_t column, size_t index) const
+        {
+            return m_y[column][index];
+        }
+
+        // Search for the first frame with an x that is not less than
+        // (or greater than) the x specified.
+        size_t LowerBound(double x) const;
+        size_t UpperBound(double x) const;
+
+        // Find the frames needed to draw the range [start_x, end_x]
+        // including one neighbouring frame either side of it.
+        bool FindRange(double  start_x,
+                       double  end_x,
+                       size_t& first,
+                       size_t& last) const;
+
+        // Find the coarsest level of the pyramids whose buckets
+        // summarise no more than the number of frames specified.
+        int GetLevel(size_t points_per_bucket) const;
+
+        // The number of frames summarised by each bucket of a level
+        size_t GetBucketSize(int level) const
+        {
+            return m_sizes[level];
+        }
+
+        // Access the closed buckets of a level of the pyramid of a
+        // column. Bucket n summarises the frames from n times the
+        // bucket size.
+        const wxTrendPlotBucket& GetBucket(size_t column, int level, size_t index) const
+        {
+            return m_buckets[column][level][index];
+        }
+
+    private:
+        struct Header
+        {
+            char     magic[8];
+            wxUint32 version;
+            wxUint32 columns;
+            wxUint64 capacity;
+            wxUint64 count;
+        };
+
+        static size_t Align(size_t size)
+        {
+            return (size + TREND_PLOT_FILE_ALIGN - 1) & ~(size_t)(TREND_PLOT_FILE_ALIGN - 1);
+        }
+
+        bool Map(const wxString& path, size_t columns, size_t capacity);
+        void Unmap(void);
+        size_t Layout(size_t columns, size_t capacity);
+        void RestoreOpenBuckets(void);
+
+        // The whole file as it is mapped into memory
+        void*   m_base;
+        size_t  m_size;
+        Header* m_header;
+
+        // The columns and pyramids within the mapping
+        double*                                      m_x;
+        std::vector<double*>                         m_y;
+        std::vector<size_t>                          m_sizes;
+        std::vector< std::vector<wxTrendPlotBucket*> > m_buckets;
+
+        // The bucket being filled at each level of the pyramid of each
+        // column. These aren't stored since they can be worked out from
+        // the frames and the closed buckets.
+        std::vector< std::vector<wxTrendPlotBucket> > m_open;
+
+#if defined(__WXMSW__)
+        void* m_file;
+        void* m_mapping;
+#else
+        int m_file;
+#endif
+};
+
+#endif // __TREND_PLOT_FILE_H__
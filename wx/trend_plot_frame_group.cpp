@@ -0,0 +1,1652 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_frame_group.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the class used to store
+//|    the points of trend plot data sets that are sampled together.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "wx/trend_plot_frame_group.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotFrameGroup()
+//|
+//| PARAMETERS:
+//|    capacity (I) - The maximum number of frames stored by the group.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the frame group class. The storage for
+//|    the x co-ordinates is allocated up front and the storage for each
+//|    column when it is added, so that adding frames never has to
+//|    allocate memory.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotFrameGroup::wxTrendPlotFrameGroup(size_t capacity)
+{
+    if(capacity == 0)
+    {
+        capacity = 1;
+    }
+
+    m_capacity = capacity;
+    m_head = 0;
+    m_count = 0;
+
+    m_max_capacity = capacity;
+    m_evicted = 0;
+    m_reported = 0;
+    m_revision = 0;
+    m_replaced = 0;
+    m_archive = false;
+    m_file = NULL;
+
+    m_uniform = false;
+    m_x0 = 0;
+    m_dt = 1;
+    m_first_sample = 0;
+    m_refs = 0;
+
+    m_x.resize(m_capacity);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotFrameGroup()
+//|
+//| PARAMETERS:
+//|    capacity (I) - The maximum number of frames stored by the group.
+//|    x0       (I) - The x co-ordinate of sample 0.
+//|    dt       (I) - The distance between samples.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for a uniform frame group. No storage is
+//|    needed for the x co-ordinates.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotFrameGroup::wxTrendPlotFrameGroup(size_t capacity,
+                                             double x0,
+                                             double dt)
+{
+    if(capacity == 0)
+    {
+        capacity = 1;
+    }
+
+    if(!(dt > 0))
+    {
+        dt = 1;
+    }
+
+    m_capacity = capacity;
+    m_head = 0;
+    m_count = 0;
+
+    m_max_capacity = capacity;
+    m_evicted = 0;
+    m_reported = 0;
+    m_revision = 0;
+    m_replaced = 0;
+    m_archive = false;
+    m_file = NULL;
+
+    m_uniform = true;
+    m_x0 = x0;
+    m_dt = dt;
+    m_first_sample = 0;
+    m_refs = 0;
+}
+
+
+wxTrendPlotFrameGroup::~wxTrendPlotFrameGroup(void)
+{
+    for(size_t index = 0; index < m_columns.size(); index++)
+    {
+        delete m_columns[index];
+    }
+
+    for(size_t index = 0; index < m_chunks.size(); index++)
+    {
+        delete m_chunks[index];
+    }
+
+    delete m_file;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddColumn()
+//|
+//| PARAMETERS:
+//|    encoding (I) - How the y co-ordinates are stored.
+//|
+//| FUNCTION:
+//|    This method adds a column of y co-ordinates to the group.
+//|
+//| RETURNS:
+//|    The column, which belongs to the group.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotColumn* wxTrendPlotFrameGroup::AddColumn(const wxTrendPlotEncoding& encoding)
+{
+    wxTrendPlotColumn* column = new wxTrendPlotColumn(m_capacity, encoding);
+
+    m_columns.push_back(column);
+
+    if(m_count != 0)
+    {
+        RebuildPyramid(column);
+    }
+
+    // The archived frames read as 0 too. Frames from now on go
+    // into a new chunk.
+    for(size_t index = 0; index < m_chunks.size(); index++)
+    {
+        m_chunks[index]->AddColumn();
+    }
+
+    if(!m_chunks.empty() && !m_chunks.back()->IsSealed())
+    {
+        m_chunks.back()->Seal();
+    }
+
+    CloseFile();
+
+    // Each frame is now bigger
+    if(m_retention.m_max_bytes != 0)
+    {
+        ApplyRetention();
+    }
+
+    return column;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    RemoveColumn()
+//|
+//| PARAMETERS:
+//|    column (I) - The column to remove.
+//|
+//| FUNCTION:
+//|    This method removes a column from the group and deletes it. Frames
+//|    added from then on have one less y co-ordinate.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::RemoveColumn(wxTrendPlotColumn* column)
+{
+    std::vector<wxTrendPlotColumn*>::iterator iter;
+
+    iter = std::find(m_columns.begin(), m_columns.end(), column);
+
+    if(iter != m_columns.end())
+    {
+        size_t index = iter - m_columns.begin();
+
+        for(size_t chunk = 0; chunk < m_chunks.size(); chunk++)
+        {
+            m_chunks[chunk]->RemoveColumn(index);
+        }
+
+        if(!m_chunks.empty() && !m_chunks.back()->IsSealed())
+        {
+            m_chunks.back()->Seal();
+        }
+
+        m_columns.erase(iter);
+        delete column;
+
+        CloseFile();
+
+        if(m_retention.m_max_bytes != 0)
+        {
+            ApplyRetention();
+        }
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddFrame()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the frame.
+//|    y (I) - The y co-ordinate for each column.
+//|
+//| FUNCTION:
+//|    This method is called to add a frame to the group. If the group is
+//|    full the oldest frame is discarded to make room for it.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::AddFrame(double x, const double* y)
+{
+    if(m_uniform)
+    {
+        AddUniformFrame(x, y);
+        EvictSpan();
+        return;
+    }
+
+    // Frames arriving out of order or replacing an existing
+    // frame take the slow path.
+    if(m_count != 0 && x <= GetX(m_count - 1))
+    {
+        InsertFrame(x, y);
+        EvictSpan();
+        return;
+    }
+
+    size_t slot;
+
+    if(m_count == m_capacity)
+    {
+        // Overwrite the oldest frame
+        DiscardFrames(1);
+        slot = m_head;
+
+        m_head++;
+        if(m_head == m_capacity)
+        {
+            m_head = 0;
+        }
+        m_first_sample++;
+    }
+    else
+    {
+        slot = Slot(m_count);
+        m_count++;
+    }
+
+    m_x[slot] = x;
+
+    for(size_t index = 0; index < m_columns.size(); index++)
+    {
+        wxTrendPlotColumn* column = m_columns[index];
+
+        column->Set(slot, y[index]);
+        column->m_pyramid.AddPoint(x, column->Get(slot));
+    }
+
+    RecordFrame(x, y);
+    EvictSpan();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddFrames()
+//|
+//| PARAMETERS:
+//|    x     (I) - The x co-ordinates of the frames.
+//|    y     (I) - The y co-ordinates of the frames, one for each column
+//|                of the first frame followed by the next frame and so on.
+//|    count (I) - The number of frames.
+//|
+//| FUNCTION:
+//|    This method is called to add a block of frames to the group. Frames
+//|    that are in order and newer than the last frame are copied straight
+//|    into the columns. Anything after the first frame that is out of
+//|    order is added one at a time.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::AddFrames(const double* x, const double* y, size_t count)
+{
+    if(m_uniform)
+    {
+        for(size_t index = 0; index < count; index++)
+        {
+            AddUniformFrame(x[index], y + (index * m_columns.size()));
+        }
+        EvictSpan();
+        return;
+    }
+
+    size_t sorted = 0;
+
+    if(count != 0 && (m_count == 0 || x[0] > GetX(m_count - 1)))
+    {
+        sorted = 1;
+
+        while(sorted < count && x[sorted] > x[sorted - 1])
+        {
+            sorted++;
+        }
+    }
+
+    AppendFrames(x, y, sorted);
+    EvictSpan();
+
+    for(size_t index = sorted; index < count; index++)
+    {
+        AddFrame(x[index], y + (index * m_columns.size()));
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddSamples()
+//|
+//| PARAMETERS:
+//|    y     (I) - The y co-ordinates of the frames, one for each column
+//|                of the first frame followed by the next frame and so on.
+//|    count (I) - The number of frames.
+//|
+//| FUNCTION:
+//|    This method is called to add a block of frames to a uniform group.
+//|    Only the y co-ordinates have to be stored.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::AddSamples(const double* y, size_t count)
+{
+    if(m_uniform)
+    {
+        AppendFrames(NULL, y, count);
+        EvictSpan();
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddUniformFrame()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the frame.
+//|    y (I) - The y co-ordinate for each column.
+//|
+//| FUNCTION:
+//|    This method adds a frame to a uniform group at the sample nearest
+//|    to x. A frame for a sample the group already holds replaces it.
+//|    Samples that were skipped are left as gaps, unless the gap is
+//|    bigger than the group in which case the group starts again at x.
+//|    A gap is NaN in a double or float column and TREND_PLOT_INT16_GAP
+//|    in a 16 bit column, which reads back as NaN. Either way it breaks
+//|    the line and is left out of the range of the data set.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::AddUniformFrame(double x, const double* y)
+{
+    double sample = floor(((x - m_x0) / m_dt) + 0.5);
+    double next = m_first_sample + m_count;
+
+    if(sample < next)
+    {
+        // The frame is older than anything we're holding
+        if(sample < m_first_sample)
+        {
+            m_evicted++;
+            return;
+        }
+
+        ReplaceFrame((size_t)(sample - m_first_sample), y);
+        return;
+    }
+
+    if(m_count == 0 || sample - next >= m_capacity)
+    {
+        // None of the frames held would survive the gap
+        DiscardFrames(m_count);
+        ClearFrames();
+        m_first_sample = sample;
+    }
+    else if(sample > next)
+    {
+        std::vector<double> gap(m_columns.size(), std::numeric_limits<double>::quiet_NaN());
+
+        for(double skipped = next; skipped < sample; skipped++)
+        {
+            AppendFrames(NULL, &gap[0], 1);
+        }
+    }
+
+    AppendFrames(NULL, y, 1);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AppendFrames()
+//|
+//| PARAMETERS:
+//|    x     (I) - The x co-ordinates of the frames, in increasing order,
+//|                or NULL for the next samples of a uniform group.
+//|    y     (I) - The y co-ordinates of the frames.
+//|    count (I) - The number of frames.
+//|
+//| FUNCTION:
+//|    This method copies a block of frames newer than the last frame into
+//|    the columns in at most two pieces, overwriting the oldest frames if
+//|    the group is full.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::AppendFrames(const double* x, const double* y, size_t count)
+{
+    size_t columns = m_columns.size();
+    double next_x = 0;
+
+    if(x == NULL)
+    {
+        next_x = GetNextX();
+    }
+
+    // The pyramids see every frame so that their buckets line up
+    // the same way as when the frames are added one at a time.
+    for(size_t column = 0; column < columns; column++)
+    {
+        const wxTrendPlotColumn* data = m_columns[column];
+        wxTrendPlotPyramid& pyramid = m_columns[column]->m_pyramid;
+
+        for(size_t index = 0; index < count; index++)
+        {
+            double value = data->Quantize(y[(index * columns) + column]);
+
+            if(x != NULL)
+            {
+                pyramid.AddPoint(x[index], value);
+            }
+            else
+            {
+                pyramid.AddPoint(next_x + (index * m_dt), value);
+            }
+        }
+    }
+
+    for(size_t index = 0; index < count && m_file != NULL; index++)
+    {
+        RecordFrame((x != NULL) ? x[index] : next_x + (index * m_dt),
+                    y + (index * columns));
+    }
+
+    // Archive or count the frames that are about to be overwritten,
+    // and the start of the block if it's too big to be stored.
+    if(m_count + count > m_capacity)
+    {
+        size_t overflow = m_count + count - m_capacity;
+        size_t held = (overflow < m_count) ? overflow : m_count;
+
+        DiscardFrames(held);
+
+        if(!m_archive)
+        {
+            m_evicted += overflow - held;
+        }
+        else
+        {
+            for(size_t index = 0; index < overflow - held; index++)
+            {
+                ArchiveFrame((x != NULL) ? x[index] : next_x + (index * m_dt),
+                             m_first_sample + m_count + index,
+                             y + (index * columns));
+            }
+        }
+    }
+
+    // Only the newest frames would survive
+    if(count > m_capacity)
+    {
+        if(x != NULL)
+        {
+            x += count - m_capacity;
+        }
+        else
+        {
+            m_first_sample += count - m_capacity;
+        }
+        y += (count - m_capacity) * columns;
+        count = m_capacity;
+    }
+
+    size_t slot = Slot(m_count);
+    size_t done = 0;
+
+    while(done < count)
+    {
+        size_t length = count - done;
+
+        if(length > m_capacity - slot)
+        {
+            length = m_capacity - slot;
+        }
+
+        if(x != NULL)
+        {
+            std::copy(x + done, x + done + length, m_x.begin() + slot);
+        }
+
+        for(size_t column = 0; column < columns; column++)
+        {
+            const double* from = y + (done * columns) + column;
+            wxTrendPlotColumn* to = m_columns[column];
+
+            for(size_t index = 0; index < length; index++)
+            {
+                to->Set(slot + index, from[index * columns]);
+            }
+        }
+
+        done += length;
+        slot = 0;
+    }
+
+    size_t total = m_count + count;
+
+    if(total > m_capacity)
+    {
+        m_head = Slot(total - m_capacity);
+        m_first_sample += total - m_capacity;
+        m_count = m_capacity;
+    }
+    else
+    {
+        m_count = total;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    InsertFrame()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the frame.
+//|    y (I) - The y co-ordinate for each column.
+//|
+//| FUNCTION:
+//|    This method inserts a frame into the middle of the group, keeping
+//|    the frames sorted by x. A frame with the same x as an existing frame
+//|    replaces it. This costs O(n) so it should only be used for frames
+//|    arriving out of order.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::InsertFrame(double x, const double* y)
+{
+    size_t low = LowerBound(x);
+
+    if(low < m_count && GetX(low) == x)
+    {
+        for(size_t column = 0; column < m_columns.size(); column++)
+        {
+            m_columns[column]->Set(Slot(low), y[column]);
+            RebuildPyramid(m_columns[column]);
+        }
+        return;
+    }
+
+    if(m_count == m_capacity)
+    {
+        // The frame is older than anything we're holding so
+        // it would be discarded straight away.
+        if(low == 0)
+        {
+            m_evicted++;
+            return;
+        }
+
+        // Discard the oldest frame to make room
+        DiscardFrames(1);
+        DropFrames(1);
+        low--;
+    }
+
+    // Shift the newer frames along by one to open up a gap
+    for(size_t index = m_count; index > low; index--)
+    {
+        m_x[Slot(index)] = m_x[Slot(index - 1)];
+    }
+
+    m_x[Slot(low)] = x;
+
+    for(size_t column = 0; column < m_columns.size(); column++)
+    {
+        wxTrendPlotColumn* data = m_columns[column];
+
+        for(size_t index = m_count; index > low; index--)
+        {
+            data->Move(Slot(index), Slot(index - 1));
+        }
+
+        data->Set(Slot(low), y[column]);
+    }
+
+    m_count++;
+
+    for(size_t column = 0; column < m_columns.size(); column++)
+    {
+        RebuildPyramid(m_columns[column]);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ReplaceFrame()
+//|
+//| PARAMETERS:
+//|    index (I) - The index of the frame.
+//|    y     (I) - The new y co-ordinate for each column.
+//|
+//| FUNCTION:
+//|    This method changes the y co-ordinates of a frame the group holds
+//|    without moving it. Only the buckets of the pyramids holding the
+//|    frame are updated and the revision is left alone. The frame is
+//|    logged instead so that the ranges can update just that frame.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::ReplaceFrame(size_t index, const double* y)
+{
+    size_t slot = Slot(index);
+
+    for(size_t column = 0; column < m_columns.size(); column++)
+    {
+        m_columns[column]->Set(slot, y[column]);
+        UpdatePyramid(m_columns[column], index);
+    }
+
+    m_replaced_x[(size_t)(m_replaced % TREND_PLOT_REPLACED_LOG_SIZE)] = GetX(index);
+    m_replaced++;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    UpdatePyramid()
+//|
+//| PARAMETERS:
+//|    column (I) - The column whose pyramid is updated.
+//|    index  (I) - The index of the frame that has changed.
+//|
+//| FUNCTION:
+//|    This method summarises the frames of the finest bucket holding a
+//|    frame again and hands it to the pyramid, which merges the buckets
+//|    above it again. The pyramid has seen every frame the group holds,
+//|    and the newest of them last, so the number of the frame in the
+//|    pyramid follows from its index. If the bucket starts with a frame
+//|    that has been evicted it is never drawn, and neither are the
+//|    buckets above it, so nothing needs updating.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::UpdatePyramid(wxTrendPlotColumn* column, size_t index)
+{
+    wxTrendPlotPyramid& pyramid = column->m_pyramid;
+    wxUint64 oldest = pyramid.GetPointCount() - m_count;
+    wxUint64 point = oldest + index;
+    wxUint64 start = point - (point % TREND_PLOT_PYRAMID_BASE_SIZE);
+
+    if(start < oldest)
+    {
+        return;
+    }
+
+    size_t first = (size_t)(start - oldest);
+    size_t last = std::min(m_count, first + TREND_PLOT_PYRAMID_BASE_SIZE);
+
+    wxTrendPlotBucket bucket;
+    bucket.count = 0;
+
+    for(size_t frame = first; frame < last; frame++)
+    {
+        wxTrendPlotBucket single;
+        single.first_x = single.last_x = single.min_x = single.max_x = GetX(frame);
+        single.first_y = single.last_y = single.min_y = single.max_y = GetY(column, frame);
+        single.count = 1;
+
+        wxTrendPlotPyramid::Merge(bucket, single);
+    }
+
+    pyramid.ReplaceBucket(point, oldest, bucket);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    RebuildPyramid()
+//|
+//| PARAMETERS:
+//|    column (I) - The column whose pyramid is rebuilt.
+//|
+//| FUNCTION:
+//|    This method rebuilds the pyramid of a column from scratch. The
+//|    pyramid can only be appended to so this is needed whenever a frame
+//|    is inserted into the middle of the group, which also changes the
+//|    revision of the group.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::RebuildPyramid(wxTrendPlotColumn* column)
+{
+    m_revision++;
+
+    column->m_pyramid.Clear();
+
+    for(size_t index = 0; index < m_count; index++)
+    {
+        column->m_pyramid.AddPoint(GetX(index), GetY(column, index));
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    LowerBound()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate to search for.
+//|
+//| FUNCTION:
+//|    This method binary searches for the first frame that has an x
+//|    co-ordinate that is not less than x. The frame of a uniform group
+//|    is worked out directly.
+//|
+//| RETURNS:
+//|    The index of the frame or GetCount() if there is no such frame.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotFrameGroup::LowerBound(double x) const
+{
+    if(m_uniform)
+    {
+        size_t index = UniformIndex(ceil((x - m_x0) / m_dt));
+
+        // Correct for any rounding in the division
+        while(index > 0 && GetX(index - 1) >= x)
+        {
+            index--;
+        }
+
+        while(index < m_count && GetX(index) < x)
+        {
+            index++;
+        }
+
+        return index;
+    }
+
+    size_t low = 0;
+    size_t high = m_count;
+
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if(GetX(middle) < x)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    UpperBound()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate to search for.
+//|
+//| FUNCTION:
+//|    This method binary searches for the first frame that has an x
+//|    co-ordinate greater than x. The frame of a uniform group is worked
+//|    out directly.
+//|
+//| RETURNS:
+//|    The index of the frame or GetCount() if there is no such frame.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotFrameGroup::UpperBound(double x) const
+{
+    if(m_uniform)
+    {
+        size_t index = UniformIndex(floor((x - m_x0) / m_dt) + 1);
+
+        // Correct for any rounding in the division
+        while(index > 0 && GetX(index - 1) > x)
+        {
+            index--;
+        }
+
+        while(index < m_count && GetX(index) <= x)
+        {
+            index++;
+        }
+
+        return index;
+    }
+
+    size_t low = 0;
+    size_t high = m_count;
+
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if(GetX(middle) <= x)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FindRange()
+//|
+//| PARAMETERS:
+//|    start_x (I) - The start of the visible range.
+//|    end_x   (I) - The end of the visible range.
+//|    first   (O) - The index of the first frame to draw.
+//|    last    (O) - One past the index of the last frame to draw.
+//|
+//| FUNCTION:
+//|    This method finds the frames that fall inside the visible range
+//|    in O(log n). The frame before start_x and the frame after end_x
+//|    are included so that the lines entering and leaving the plot
+//|    are drawn.
+//|
+//| RETURNS:
+//|    false if there are no frames to draw, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotFrameGroup::FindRange(double  start_x,
+                                      double  end_x,
+                                      size_t& first,
+                                      size_t& last) const
+{
+    first = UpperBound(start_x);
+
+    if(first != 0)
+    {
+        first--;
+    }
+
+    last = LowerBound(end_x);
+
+    if(last != m_count)
+    {
+        last++;
+    }
+
+    return first < last;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FindBuckets()
+//|
+//| PARAMETERS:
+//|    column  (I) - The column to draw.
+//|    level   (I) - The level of the pyramid.
+//|    start_x (I) - The start of the visible range.
+//|    end_x   (I) - The end of the visible range.
+//|    first   (O) - The index of the first bucket to draw.
+//|    last    (O) - One past the index of the last bucket to draw.
+//|
+//| FUNCTION:
+//|    This method finds the buckets of the pyramid of a column that fall
+//|    inside the visible range. Buckets that summarise frames that have
+//|    since been overwritten are skipped.
+//|
+//| RETURNS:
+//|    false if there are no buckets to draw, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotFrameGroup::FindBuckets(const wxTrendPlotColumn* column,
+                                        int                      level,
+                                        double                   start_x,
+                                        double                   end_x,
+                                        size_t&                  first,
+                                        size_t&                  last) const
+{
+    const wxTrendPlotPyramid& pyramid = column->m_pyramid;
+
+    if(m_count == 0 ||
+       !pyramid.FindRange(level, start_x, end_x, first, last))
+    {
+        return false;
+    }
+
+    double oldest = GetX(0);
+
+    while(first < last && pyramid.GetBucket(level, first).first_x < oldest)
+    {
+        first++;
+    }
+
+    return first < last;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Clear()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called to remove all the frames from the group,
+//|    including any that have been archived. The storage is kept for
+//|    re-use. A uniform group carries on from the sample after the last
+//|    frame.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::Clear(void)
+{
+    ClearFrames();
+    ClearArchive();
+}
+
+
+void wxTrendPlotFrameGroup::ClearFrames(void)
+{
+    m_revision++;
+
+    m_first_sample += m_count;
+    m_head = 0;
+    m_count = 0;
+
+    for(size_t index = 0; index < m_columns.size(); index++)
+    {
+        m_columns[index]->m_pyramid.Clear();
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetRetention()
+//|
+//| PARAMETERS:
+//|    retention (I) - The limits on the frames kept.
+//|
+//| FUNCTION:
+//|    This method sets the retention policy of the group. The count and
+//|    byte limits resize the storage of the group, which is the only time
+//|    it is reallocated, so the memory really is given back. The group
+//|    never grows beyond the capacity it was created with.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::SetRetention(const wxTrendPlotRetention& retention)
+{
+    m_retention = retention;
+
+    ApplyRetention();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetFrameSize()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method works out the memory used by each frame of the group.
+//|    This is the x co-ordinate, unless the group is uniform, the y
+//|    co-ordinate of each column and the share of the pyramid of each
+//|    column, which holds about two buckets per base size of frames.
+//|
+//| RETURNS:
+//|    The number of bytes.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotFrameGroup::GetFrameSize(void) const
+{
+    size_t size = m_uniform ? 0 : sizeof(double);
+
+    for(size_t index = 0; index < m_columns.size(); index++)
+    {
+        size += m_columns[index]->GetSampleSize();
+        size += (2 * sizeof(wxTrendPlotBucket)) / TREND_PLOT_PYRAMID_BASE_SIZE;
+    }
+
+    if(size == 0)
+    {
+        size = 1;
+    }
+
+    return size;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ApplyRetention()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method resizes the group to the number of frames allowed by
+//|    the count and byte limits of the retention policy and then evicts
+//|    any frames outside the span limit.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::ApplyRetention(void)
+{
+    size_t capacity = m_max_capacity;
+
+    if(m_retention.m_max_count != 0 && m_retention.m_max_count < capacity)
+    {
+        capacity = m_retention.m_max_count;
+    }
+
+    if(m_retention.m_max_bytes != 0)
+    {
+        size_t frames = m_retention.m_max_bytes / GetFrameSize();
+
+        if(frames == 0)
+        {
+            frames = 1;
+        }
+
+        if(frames < capacity)
+        {
+            capacity = frames;
+        }
+    }
+
+    if(capacity != m_capacity)
+    {
+        Resize(capacity);
+    }
+
+    EvictSpan();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Resize()
+//|
+//| PARAMETERS:
+//|    capacity (I) - The new number of frames the group can hold.
+//|
+//| FUNCTION:
+//|    This method reallocates the storage of the group, keeping as many
+//|    of the newest frames as will fit. The frames kept are moved to the
+//|    start of the storage and the pyramids are rebuilt at the new size.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::Resize(size_t capacity)
+{
+    if(m_count > capacity)
+    {
+        DiscardFrames(m_count - capacity);
+        DropFrames(m_count - capacity);
+    }
+
+    if(!m_uniform)
+    {
+        std::vector<double> x(capacity);
+
+        for(size_t index = 0; index < m_count; index++)
+        {
+            x[index] = GetX(index);
+        }
+
+        m_x.swap(x);
+    }
+
+    for(size_t index = 0; index < m_columns.size(); index++)
+    {
+        m_columns[index]->Resize(capacity, m_head, m_count);
+    }
+
+    m_capacity = capacity;
+    m_head = 0;
+
+    for(size_t index = 0; index < m_columns.size(); index++)
+    {
+        m_columns[index]->m_pyramid = wxTrendPlotPyramid(capacity);
+        RebuildPyramid(m_columns[index]);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DropFrames()
+//|
+//| PARAMETERS:
+//|    count (I) - The number of frames to drop, which can't be more than
+//|                the number of frames held.
+//|
+//| FUNCTION:
+//|    This method drops the oldest frames of the group. The pyramids are
+//|    left alone since FindBuckets() skips any buckets that summarise
+//|    frames that have gone.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::DropFrames(size_t count)
+{
+    m_head = Slot(count);
+    m_count -= count;
+    m_first_sample += count;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DiscardFrames()
+//|
+//| PARAMETERS:
+//|    count (I) - The number of frames, which can't be more than the
+//|                number of frames held.
+//|
+//| FUNCTION:
+//|    This method is called before the oldest frames are pushed out of
+//|    the group to make room. If the group is archiving they are added
+//|    to the archive, otherwise they are counted as evicted.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::DiscardFrames(size_t count)
+{
+    if(!m_archive)
+    {
+        m_evicted += count;
+        return;
+    }
+
+    m_archive_y.resize(m_columns.size());
+
+    for(size_t index = 0; index < count; index++)
+    {
+        for(size_t column = 0; column < m_columns.size(); column++)
+        {
+            m_archive_y[column] = GetY(m_columns[column], index);
+        }
+
+        ArchiveFrame(GetX(index),
+                     m_first_sample + index,
+                     m_archive_y.empty() ? NULL : &m_archive_y[0]);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ArchiveFrame()
+//|
+//| PARAMETERS:
+//|    x      (I) - The x co-ordinate of the frame.
+//|    sample (I) - The sample number of the frame of a uniform group.
+//|    y      (I) - The y co-ordinate for each column.
+//|
+//| FUNCTION:
+//|    This method compresses a frame onto the end of the archive. A new
+//|    chunk is started when the last one is full or, for a uniform group,
+//|    when the frame doesn't follow on from the last one.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::ArchiveFrame(double x, double sample, const double* y)
+{
+    wxTrendPlotChunk* chunk = m_chunks.empty() ? NULL : m_chunks.back();
+
+    if(chunk == NULL ||
+       chunk->IsFull() ||
+       (m_uniform && chunk->GetNextSample() != sample))
+    {
+        if(chunk != NULL && !chunk->IsSealed())
+        {
+            chunk->Seal();
+        }
+
+        if(m_uniform)
+        {
+            chunk = new wxTrendPlotChunk(m_columns.size(), m_x0, m_dt, sample);
+        }
+        else
+        {
+            chunk = new wxTrendPlotChunk(m_columns.size());
+        }
+
+        m_chunks.push_back(chunk);
+    }
+
+    chunk->AddFrame(x, y);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetArchive()
+//|
+//| PARAMETERS:
+//|    archive (I) - Set to keep the frames pushed out of the group.
+//|
+//| FUNCTION:
+//|    This method turns the archive on or off. When it is on, frames
+//|    pushed out of the group because it is full are compressed into
+//|    chunks instead of being discarded. They are still subject to the
+//|    span limit of the retention policy. Turning the archive off
+//|    discards the frames in it.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::SetArchive(bool archive)
+{
+    m_archive = archive;
+
+    if(!m_archive)
+    {
+        for(size_t index = 0; index < m_chunks.size(); index++)
+        {
+            m_evicted += m_chunks[index]->GetCount();
+        }
+
+        ClearArchive();
+    }
+}
+
+
+void wxTrendPlotFrameGroup::ClearArchive(void)
+{
+    for(size_t index = 0; index < m_chunks.size(); index++)
+    {
+        delete m_chunks[index];
+    }
+
+    m_chunks.clear();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetArchiveSize()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method works out the memory used by the archive.
+//|
+//| RETURNS:
+//|    The number of bytes.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotFrameGroup::GetArchiveSize(void) const
+{
+    size_t size = 0;
+
+    for(size_t index = 0; index < m_chunks.size(); index++)
+    {
+        size += m_chunks[index]->GetSize();
+    }
+
+    return size;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FindChunk()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate to search for.
+//|
+//| FUNCTION:
+//|    This method binary searches the archive for the first chunk whose
+//|    last frame is at or after x.
+//|
+//| RETURNS:
+//|    The index of the chunk or GetChunkCount() if there is no such chunk.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotFrameGroup::FindChunk(double x) const
+{
+    size_t low = 0;
+    size_t high = m_chunks.size();
+
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if(m_chunks[middle]->GetLastX() < x)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetColumnIndex()
+//|
+//| PARAMETERS:
+//|    column (I) - The column.
+//|
+//| FUNCTION:
+//|    This method finds the position of a column in the frames of the
+//|    group, which is also its position in the chunks of the archive.
+//|
+//| RETURNS:
+//|    The index of the column or GetColumnCount() if it isn't in the
+//|    group.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotFrameGroup::GetColumnIndex(const wxTrendPlotColumn* column) const
+{
+    size_t index = 0;
+
+    while(index < m_columns.size() && m_columns[index] != column)
+    {
+        index++;
+    }
+
+    return index;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetFile()
+//|
+//| PARAMETERS:
+//|    file (I) - The file to record the frames in, or NULL to stop
+//|               recording them.
+//|
+//| FUNCTION:
+//|    This method sets the file the frames appended to the group are
+//|    recorded in. An empty group is filled with the newest frames of
+//|    the file, as many as it can hold, so a recording carries on from
+//|    where it left off. The older frames stay in the file and are only
+//|    read when they are drawn. Frames inserted out of order and frames
+//|    added once the file is full aren't recorded.
+//|
+//| RETURNS:
+//|    False if the file doesn't have a y for each column, in which case
+//|    it still belongs to the caller.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotFrameGroup::SetFile(wxTrendPlotFile* file)
+{
+    if(file != NULL && file->GetColumnCount() != m_columns.size())
+    {
+        return false;
+    }
+
+    if(file == m_file)
+    {
+        return true;
+    }
+
+    CloseFile();
+
+    if(file != NULL && m_count == 0 && file->GetCount() != 0)
+    {
+        size_t columns = m_columns.size();
+        size_t count = std::min(m_capacity, file->GetCount());
+        size_t start = file->GetCount() - count;
+
+        // A uniform group can only take the frames since the last
+        // gap that it started again after.
+        if(m_uniform)
+        {
+            double last = floor(((file->GetX(start + count - 1) - m_x0) / m_dt) + 0.5);
+
+            while(count > 1 &&
+                  floor(((file->GetX(start) - m_x0) / m_dt) + 0.5) != last - (count - 1))
+            {
+                start++;
+                count--;
+            }
+        }
+
+        std::vector<double> x(count);
+        std::vector<double> y(count * columns);
+
+        for(size_t index = 0; index < count; index++)
+        {
+            x[index] = file->GetX(start + index);
+
+            for(size_t column = 0; column < columns; column++)
+            {
+                y[(index * columns) + column] = file->GetY(column, start + index);
+            }
+        }
+
+        if(m_uniform)
+        {
+            m_first_sample = floor(((x[0] - m_x0) / m_dt) + 0.5);
+            AppendFrames(NULL, &y[0], count);
+        }
+        else
+        {
+            AppendFrames(&x[0], &y[0], count);
+        }
+    }
+
+    m_file = file;
+
+    return true;
+}
+
+
+void wxTrendPlotFrameGroup::RecordFrame(double x, const double* y)
+{
+    if(m_file == NULL)
+    {
+        return;
+    }
+
+    // Record what the columns read back so that the history
+    // looks the same once it has left the group.
+    m_file_y.resize(m_columns.size());
+
+    for(size_t column = 0; column < m_columns.size(); column++)
+    {
+        m_file_y[column] = m_columns[column]->Quantize(y[column]);
+    }
+
+    m_file->AddFrame(x, m_file_y.empty() ? NULL : &m_file_y[0]);
+}
+
+
+void wxTrendPlotFrameGroup::CloseFile(void)
+{
+    delete m_file;
+    m_file = NULL;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    EvictSpan()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method evicts the oldest frames until the group spans no more
+//|    than the maximum span of the retention policy. The newest frame is
+//|    always kept. Chunks of the archive are only evicted once all of
+//|    their frames are too old.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotFrameGroup::EvictSpan(void)
+{
+    if(m_retention.m_max_span <= 0 || m_count == 0)
+    {
+        return;
+    }
+
+    double oldest = GetX(m_count - 1) - m_retention.m_max_span;
+
+    // The archive is older than any of the frames held so whole
+    // chunks go first.
+    while(!m_chunks.empty() && m_chunks.front()->GetLastX() < oldest)
+    {
+        m_evicted += m_chunks.front()->GetCount();
+
+        delete m_chunks.front();
+        m_chunks.pop_front();
+    }
+
+    size_t count = 0;
+
+    while(count < m_count - 1 && GetX(count) < oldest)
+    {
+        count++;
+    }
+
+    if(count != 0)
+    {
+        m_evicted += count;
+        DropFrames(count);
+    }
+}
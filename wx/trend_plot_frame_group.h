@@ -0,0 +1,403 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_frame_group.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the class used to store the
+//|    points of trend plot data sets that are sampled together.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_FRAME_GROUP_H__
+#define __TREND_PLOT_FRAME_GROUP_H__
+
+#include <deque>
+#include <vector>
+
+#include "wx/trend_plot_chunk.h"
+#include "wx/trend_plot_column.h"
+#include "wx/trend_plot_file.h"
+#include "wx/trend_plot_ref.h"
+
+// The number of frames replaced in place that a group remembers, so
+// that the ranges kept over it can catch up with them.
+#define TREND_PLOT_REPLACED_LOG_SIZE 64
+
+
+//+------------------------------------------------------------------------------
+//|
+//| STRUCTURE:
+//|    wxTrendPlotRetention
+//|
+//| DESCRIPTION:
+//|    This structure limits how much of its history a frame group keeps.
+//|    The oldest frames are evicted once the group holds more than the
+//|    maximum count, spans more than the maximum x range behind the
+//|    newest frame or would use more than the maximum number of bytes.
+//|    A limit of 0 means that there is no limit.
+//|
+//+------------------------------------------------------------------------------
+struct wxTrendPlotRetention
+{
+    wxTrendPlotRetention(size_t max_count = 0,
+                         double max_span = 0,
+                         size_t max_bytes = 0)
+    {
+        m_max_count = max_count;
+        m_max_span = max_span;
+        m_max_bytes = max_bytes;
+    }
+
+    size_t m_max_count;
+    double m_max_span;
+    size_t m_max_bytes;
+};
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotFrameGroup
+//|
+//| DESCRIPTION:
+//|    This class stores the points of one or more data sets that share the
+//|    same x co-ordinates. Each frame is an x co-ordinate and a y for every
+//|    column. The x co-ordinates are kept once for the whole group, sorted,
+//|    in a ring buffer of fixed capacity, and each column keeps its y
+//|    co-ordinates in a ring buffer laid out the same way. Once the buffer
+//|    is full the oldest frames are overwritten by new ones.
+//|
+//|    A uniform group is sampled at a fixed rate so the x co-ordinates
+//|    aren't stored at all. Frame n is at x0 + n * dt, which also turns
+//|    the search for the visible frames into arithmetic.
+//|
+//|    A retention policy can hold the group to less than its capacity.
+//|    The storage shrinks to fit the count and byte limits, and frames
+//|    older than the span limit are evicted as new frames are added.
+//|
+//|    The group can also archive the frames pushed out of it, keeping a
+//|    long history in compressed chunks behind the frames it holds. The
+//|    chunks have to be decoded to be drawn.
+//|
+//|    Alternatively the group can record every frame appended to it in a
+//|    memory mapped file, which keeps the whole history on disk and can
+//|    be drawn straight from the mapping.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotFrameGroup
+{
+    public:
+        wxTrendPlotFrameGroup(size_t capacity);
+
+        // Create a uniform group sampled every dt from x0
+        wxTrendPlotFrameGroup(size_t capacity, double x0, double dt);
+
+        ~wxTrendPlotFrameGroup(void);
+
+        // Add a column to the group. The column reads as 0 for any
+        // frames that were added before it.
+        wxTrendPlotColumn* AddColumn(const wxTrendPlotEncoding& encoding = wxTrendPlotEncoding());
+
+        // Remove and delete a column
+        void RemoveColumn(wxTrendPlotColumn* column);
+
+        size_t GetColumnCount(void) const
+        {
+            return m_columns.size();
+        }
+
+        // Add a frame to the group. There must be a y for each column
+        // in the order the columns were added. Frames newer than the
+        // last frame are appended in constant time, anything else falls
+        // back to a sorted insert.
+        void AddFrame(double x, const double* y);
+
+        // Add a block of frames to the group. The y co-ordinates are
+        // stored a frame at a time, one for each column.
+        void AddFrames(const double* x, const double* y, size_t count);
+
+        // Add a block of frames to a uniform group, each one sample
+        // after the last frame. The y co-ordinates are stored a frame
+        // at a time, one for each column.
+        void AddSamples(const double* y, size_t count);
+
+        bool IsUniform(void) const
+        {
+            return m_uniform;
+        }
+
+        // The x co-ordinate of the next frame of a uniform group
+        double GetNextX(void) const
+        {
+            return m_x0 + ((m_first_sample + m_count) * m_dt);
+        }
+
+        // Remove all the frames from the group
+        void Clear(void);
+
+        size_t GetCount(void) const
+        {
+            return m_count;
+        }
+
+        // The number of frames the group can hold, which is less
+        // than the capacity it was created with if the retention
+        // policy limits the count or the bytes used.
+        size_t GetCapacity(void) const
+        {
+            return m_capacity;
+        }
+
+        // Limit how much of its history the group keeps. Frames
+        // beyond the new limits are evicted straight away.
+        void SetRetention(const wxTrendPlotRetention& retention);
+
+        const wxTrendPlotRetention& GetRetention(void) const
+        {
+            return m_retention;
+        }
+
+        // The approximate number of bytes used to store each frame
+        size_t GetFrameSize(void) const;
+
+        // The total number of frames discarded to stay within the
+        // capacity, unless they were archived, or the retention
+        // policy.
+        wxUint64 GetEvictedCount(void) const
+        {
+            return m_evicted;
+        }
+
+        // Keep the frames pushed out of the group in compressed
+        // chunks instead of discarding them.
+        void SetArchive(bool archive);
+
+        bool IsArchiving(void) const
+        {
+            return m_archive;
+        }
+
+        // Access the chunks of the archive in order, index 0 being
+        // the oldest. They are all older than the frames held.
+        size_t GetChunkCount(void) const
+        {
+            return m_chunks.size();
+        }
+
+        const wxTrendPlotChunk& GetChunk(size_t index) const
+        {
+            return *m_chunks[index];
+        }
+
+        // Find the first chunk whose last frame is at or after x
+        size_t FindChunk(double x) const;
+
+        // The number of bytes used by the archive
+        size_t GetArchiveSize(void) const;
+
+        // Record the frames appended to the group in a file, which
+        // then belongs to the group. The file must have a y for each
+        // column. If the group is empty it is filled with the newest
+        // frames of the file. Adding or removing a column closes the
+        // file, since its layout no longer matches.
+        bool SetFile(wxTrendPlotFile* file);
+
+        const wxTrendPlotFile* GetFile(void) const
+        {
+            return m_file;
+        }
+
+        // The position of a column within each frame
+        size_t GetColumnIndex(const wxTrendPlotColumn* column) const;
+
+        // The number of frames evicted since the last call
+        wxUint64 TakeEvicted(void)
+        {
+            wxUint64 count = m_evicted - m_reported;
+
+            m_reported = m_evicted;
+
+            return count;
+        }
+
+        // Changes whenever frames that were already held are changed
+        // or removed, other than by being evicted or replaced.
+        wxUint64 GetRevision(void) const
+        {
+            return m_revision;
+        }
+
+        // The number of frames that have been replaced in place, by
+        // a uniform frame for a sample the group already holds.
+        wxUint64 GetReplacedCount(void) const
+        {
+            return m_replaced;
+        }
+
+        // The x co-ordinate of a replaced frame, numbered from 0. Only
+        // the last TREND_PLOT_REPLACED_LOG_SIZE of them are kept.
+        double GetReplacedX(wxUint64 number) const
+        {
+            return m_replaced_x[(size_t)(number % TREND_PLOT_REPLACED_LOG_SIZE)];
+        }
+
+        // Access the frames in order, index 0 being the oldest frame.
+        double GetX(size_t index) const
+        {
+            if(m_uniform)
+            {
+                return m_x0 + ((m_first_sample + index) * m_dt);
+            }
+
+            return m_x[Slot(index)];
+        }
+
+        double GetY(const wxTrendPlotColumn* column, size_t index) const
+        {
+            return column->Get(Slot(index));
+        }
+
+        // Find the frames needed to draw the range [start_x, end_x]
+        // including one neighbouring frame either side of it.
+        bool FindRange(double  start_x,
+                       double  end_x,
+                       size_t& first,
+                       size_t& last) const;
+
+        // Find the buckets of a level of the pyramid of a column
+        // needed to draw the range [start_x, end_x].
+        bool FindBuckets(const wxTrendPlotColumn* column,
+                         int                      level,
+                         double                   start_x,
+                         double                   end_x,
+                         size_t&                  first,
+                         size_t&                  last) const;
+
+        // Map the index of a frame to its position in the columns
+        size_t Slot(size_t index) const
+        {
+            size_t slot = m_head + index;
+
+            if(slot >= m_capacity)
+            {
+                slot -= m_capacity;
+            }
+
+            return slot;
+        }
+
+        // Called by wxTrendPlotFrameGroupPtr. The group is only
+        // shared by data sets on the GUI thread.
+        void AddRef(void)
+        {
+            m_refs++;
+        }
+
+        bool Release(void)
+        {
+            return --m_refs == 0;
+        }
+
+    private:
+        // Searches for the first frame with an x that is not less
+        // than (or greater than) the x specified.
+        size_t LowerBound(double x) const;
+        size_t UpperBound(double x) const;
+
+        // Convert a sample number of a uniform group to the index
+        // of a frame, limited to the frames held.
+        size_t UniformIndex(double sample) const
+        {
+            sample -= m_first_sample;
+
+            if(!(sample > 0))
+            {
+                return 0;
+            }
+
+            if(sample > m_count)
+            {
+                return m_count;
+            }
+
+            return (size_t)sample;
+        }
+
+        void AppendFrames(const double* x, const double* y, size_t count);
+        void InsertFrame(double x, const double* y);
+        void AddUniformFrame(double x, const double* y);
+        void ReplaceFrame(size_t index, const double* y);
+        void RebuildPyramid(wxTrendPlotColumn* column);
+        void UpdatePyramid(wxTrendPlotColumn* column, size_t index);
+
+        // Work out the capacity allowed by the retention policy,
+        // resize the storage to it and evict any frames outside it.
+        void ApplyRetention(void);
+        void Resize(size_t capacity);
+
+        // Drop the oldest frames
+        void DropFrames(size_t count);
+
+        // Archive or count the oldest frames before they are
+        // pushed out to make room.
+        void DiscardFrames(size_t count);
+        void ArchiveFrame(double x, double sample, const double* y);
+
+        void ClearFrames(void);
+        void ClearArchive(void);
+
+        // Append a frame to the file, if there is one
+        void RecordFrame(double x, const double* y);
+        void CloseFile(void);
+
+        // Evict the frames further behind the newest frame than the
+        // maximum span. Each frame is only looked at once before it
+        // is evicted so the cost is constant when amortized.
+        void EvictSpan(void);
+
+        std::vector<double>             m_x;
+        std::vector<wxTrendPlotColumn*> m_columns;
+
+        size_t m_capacity;
+        size_t m_head;
+        size_t m_count;
+
+        // The capacity the group was created with and the policy
+        // that may hold it to less.
+        size_t               m_max_capacity;
+        wxTrendPlotRetention m_retention;
+
+        wxUint64 m_evicted;
+        wxUint64 m_reported;
+        wxUint64 m_revision;
+
+        // The frames replaced in place
+        wxUint64 m_replaced;
+        double   m_replaced_x[TREND_PLOT_REPLACED_LOG_SIZE];
+
+        // The compressed frames that have been pushed out
+        bool                          m_archive;
+        std::deque<wxTrendPlotChunk*> m_chunks;
+        std::vector<double>           m_archive_y;
+
+        // The file the frames are recorded in
+        wxTrendPlotFile*    m_file;
+        std::vector<double> m_file_y;
+
+        // The sampling of a uniform group. The sample number of
+        // the oldest frame is kept as a double so that it can be
+        // negative and holds whole numbers exactly up to 2^53.
+        bool   m_uniform;
+        double m_x0;
+        double m_dt;
+        double m_first_sample;
+
+        // The number of data sets sharing the group
+        size_t m_refs;
+};
+
+typedef wxTrendPlotRef<wxTrendPlotFrameGroup> wxTrendPlotFrameGroupPtr;
+
+#endif // __TREND_PLOT_FRAME_GROUP_H__
@@ -0,0 +1,522 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_pyramid.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of a multi-resolution summary of
+//|    a trend plot data set used to draw zoomed out plots quickly.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include "wx/trend_plot_pyramid.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotPyramid()
+//|
+//| PARAMETERS:
+//|    capacity (I) - The number of points held by the data set.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the pyramid class. Levels are created
+//|    until a single bucket would cover the whole data set and each level
+//|    holds enough buckets to cover the capacity of the data set.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotPyramid::wxTrendPlotPyramid(size_t capacity)
+{
+    for(size_t size = TREND_PLOT_PYRAMID_BASE_SIZE;
+        size <= capacity;
+        size *= 2)
+    {
+        Level level;
+        level.buckets.resize((capacity + size - 1) / size + 1);
+        level.head = 0;
+        level.count = 0;
+        level.size = size;
+        level.open.count = 0;
+
+        m_levels.push_back(level);
+    }
+
+    m_points = 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Clear()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called to remove all the buckets from the pyramid.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotPyramid::Clear(void)
+{
+    for(size_t index = 0; index < m_levels.size(); index++)
+    {
+        m_levels[index].head = 0;
+        m_levels[index].count = 0;
+        m_levels[index].open.count = 0;
+    }
+
+    m_points = 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddPoint()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the point.
+//|    y (I) - The y co-ordinate of the point.
+//|
+//| FUNCTION:
+//|    This method adds a point to the finest level of the pyramid. When a
+//|    bucket fills up it is closed and merged into the level above, so
+//|    the cost of adding a point is constant when amortized.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotPyramid::AddPoint(double x, double y)
+{
+    wxTrendPlotBucket bucket;
+    bucket.first_x = x;
+    bucket.first_y = y;
+    bucket.last_x = x;
+    bucket.last_y = y;
+    bucket.min_x = x;
+    bucket.min_y = y;
+    bucket.max_x = x;
+    bucket.max_y = y;
+    bucket.count = 1;
+
+    m_points++;
+
+    for(size_t index = 0; index < m_levels.size(); index++)
+    {
+        Level& level = m_levels[index];
+
+        Merge(level.open, bucket);
+
+        if(level.open.count < level.size)
+        {
+            break;
+        }
+
+        // The bucket is full so close it, overwriting the
+        // oldest bucket if the level is full.
+        size_t slot = level.head + level.count;
+        if(slot >= level.buckets.size())
+        {
+            slot -= level.buckets.size();
+        }
+
+        level.buckets[slot] = level.open;
+
+        if(level.count == level.buckets.size())
+        {
+            level.head++;
+            if(level.head == level.buckets.size())
+            {
+                level.head = 0;
+            }
+        }
+        else
+        {
+            level.count++;
+        }
+
+        bucket = level.open;
+        level.open.count = 0;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ReplaceBucket()
+//|
+//| PARAMETERS:
+//|    point  (I) - The number of the point that has changed.
+//|    oldest (I) - The number of the oldest point still held.
+//|    bucket (I) - The finest bucket holding the point, summarising the
+//|                 points as they are now.
+//|
+//| FUNCTION:
+//|    This method is called when a point that has already been added is
+//|    changed. The finest bucket holding it is replaced and each bucket
+//|    above it is merged again from the closed buckets below, which is
+//|    what it was built from. Buckets that start before the oldest point
+//|    are never drawn so they are left alone, along with the buckets
+//|    above them.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotPyramid::ReplaceBucket(wxUint64                 point,
+                                       wxUint64                 oldest,
+                                       const wxTrendPlotBucket& bucket)
+{
+    for(size_t level = 0; level < m_levels.size(); level++)
+    {
+        wxUint64 size = m_levels[level].size;
+        wxUint64 number = point / size;
+
+        if(number * size < oldest)
+        {
+            break;
+        }
+
+        wxTrendPlotBucket* into = FindBucket(level, number);
+
+        if(into == NULL)
+        {
+            break;
+        }
+
+        if(level == 0)
+        {
+            *into = bucket;
+            continue;
+        }
+
+        // The open bucket of the level below hasn't been merged
+        // into this level yet.
+        wxUint64 closed = m_points / m_levels[level - 1].size;
+        wxTrendPlotBucket merged;
+        merged.count = 0;
+
+        for(wxUint64 child = number * 2; child < (number * 2) + 2 && child < closed; child++)
+        {
+            const wxTrendPlotBucket* from = FindBucket(level - 1, child);
+
+            if(from == NULL)
+            {
+                return;
+            }
+
+            Merge(merged, *from);
+        }
+
+        *into = merged;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FindBucket()
+//|
+//| PARAMETERS:
+//|    level  (I) - The level of the pyramid.
+//|    number (I) - The number of the bucket, 0 being the first bucket
+//|                 started since the pyramid was cleared.
+//|
+//| FUNCTION:
+//|    This method finds a bucket that may still be held by a level. Each
+//|    level closes a bucket every time its size in points is added, so
+//|    the number of buckets it has closed follows from the number of
+//|    points.
+//|
+//| RETURNS:
+//|    The bucket or NULL if it isn't held.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotBucket* wxTrendPlotPyramid::FindBucket(size_t level, wxUint64 number)
+{
+    Level& data = m_levels[level];
+    wxUint64 closed = m_points / data.size;
+
+    if(number == closed)
+    {
+        return (data.open.count != 0) ? &data.open : NULL;
+    }
+
+    if(number > closed || closed - number > data.count)
+    {
+        return NULL;
+    }
+
+    size_t slot = data.head + (data.count - (size_t)(closed - number));
+    if(slot >= data.buckets.size())
+    {
+        slot -= data.buckets.size();
+    }
+
+    return &data.buckets[slot];
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Merge()
+//|
+//| PARAMETERS:
+//|    into (IO) - The bucket to merge into.
+//|    from (I)  - The bucket that follows it.
+//|
+//| FUNCTION:
+//|    This method merges a bucket into the bucket preceding it. Gaps in
+//|    the data are left out of the minimum and maximum.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotPyramid::Merge(wxTrendPlotBucket& into, const wxTrendPlotBucket& from)
+{
+    if(into.count == 0)
+    {
+        into = from;
+        return;
+    }
+
+    into.last_x = from.last_x;
+    into.last_y = from.last_y;
+
+    // A bucket that only holds gaps has no minimum or maximum
+    if(from.min_y < into.min_y || into.min_y != into.min_y)
+    {
+        into.min_x = from.min_x;
+        into.min_y = from.min_y;
+    }
+
+    if(from.max_y > into.max_y || into.max_y != into.max_y)
+    {
+        into.max_x = from.max_x;
+        into.max_y = from.max_y;
+    }
+
+    into.count += from.count;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetLevel()
+//|
+//| PARAMETERS:
+//|    points_per_bucket (I) - The most points a bucket may summarise.
+//|
+//| FUNCTION:
+//|    This method finds the coarsest level that is still fine enough
+//|    to draw from.
+//|
+//| RETURNS:
+//|    The level or -1 if the points should be drawn directly.
+//|
+//+------------------------------------------------------------------------------
+int wxTrendPlotPyramid::GetLevel(size_t points_per_bucket) const
+{
+    int level = -1;
+
+    for(size_t index = 0; index < m_levels.size(); index++)
+    {
+        if(m_levels[index].size > points_per_bucket)
+        {
+            break;
+        }
+
+        level = index;
+    }
+
+    return level;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetBucketCount()
+//|
+//| PARAMETERS:
+//|    level (I) - The level of the pyramid.
+//|
+//| FUNCTION:
+//|    This method returns the number of buckets in a level, including the
+//|    partially filled bucket at the end.
+//|
+//| RETURNS:
+//|    The number of buckets.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotPyramid::GetBucketCount(int level) const
+{
+    const Level& data = m_levels[level];
+
+    if(data.open.count != 0)
+    {
+        return data.count + 1;
+    }
+
+    return data.count;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetBucket()
+//|
+//| PARAMETERS:
+//|    level (I) - The level of the pyramid.
+//|    index (I) - The index of the bucket, 0 being the oldest.
+//|
+//| FUNCTION:
+//|    This method is called to access the buckets of a level in order.
+//|
+//| RETURNS:
+//|    The bucket.
+//|
+//+------------------------------------------------------------------------------
+const wxTrendPlotBucket& wxTrendPlotPyramid::GetBucket(int level, size_t index) const
+{
+    const Level& data = m_levels[level];
+
+    if(index == data.count)
+    {
+        return data.open;
+    }
+
+    size_t slot = data.head + index;
+    if(slot >= data.buckets.size())
+    {
+        slot -= data.buckets.size();
+    }
+
+    return data.buckets[slot];
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FindRange()
+//|
+//| PARAMETERS:
+//|    level   (I) - The level of the pyramid.
+//|    start_x (I) - The start of the visible range.
+//|    end_x   (I) - The end of the visible range.
+//|    first   (O) - The index of the first bucket to draw.
+//|    last    (O) - One past the index of the last bucket to draw.
+//|
+//| FUNCTION:
+//|    This method binary searches for the buckets overlapping the visible
+//|    range, including one neighbouring bucket either side of it.
+//|
+//| RETURNS:
+//|    false if there are no buckets to draw, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotPyramid::FindRange(int     level,
+                                   double  start_x,
+                                   double  end_x,
+                                   size_t& first,
+                                   size_t& last) const
+{
+    size_t count = GetBucketCount(level);
+
+    // Find the first bucket that starts after start_x
+    size_t low = 0;
+    size_t high = count;
+
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if(GetBucket(level, middle).first_x <= start_x)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    first = low;
+    if(first != 0)
+    {
+        first--;
+    }
+
+    // Find the first bucket that reaches end_x
+    low = first;
+    high = count;
+
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if(GetBucket(level, middle).last_x < end_x)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    last = low;
+    if(last != count)
+    {
+        last++;
+    }
+
+    return first < last;
+}
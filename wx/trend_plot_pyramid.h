@@ -0,0 +1,129 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_pyramid.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of a multi-resolution summary of
+//|    a trend plot data set used to draw zoomed out plots quickly.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_PYRAMID_H__
+#define __TREND_PLOT_PYRAMID_H__
+
+#include <vector>
+#include <wx/defs.h>
+
+// The number of points summarised by each bucket of the finest
+// level of the pyramid. Each coarser level doubles this.
+#define TREND_PLOT_PYRAMID_BASE_SIZE 16
+
+
+//+------------------------------------------------------------------------------
+//|
+//| STRUCTURE:
+//|    wxTrendPlotBucket
+//|
+//| DESCRIPTION:
+//|    This structure summarises a run of consecutive points.
+//|
+//+------------------------------------------------------------------------------
+struct wxTrendPlotBucket
+{
+    double first_x;
+    double first_y;
+    double last_x;
+    double last_y;
+    double min_x;
+    double min_y;
+    double max_x;
+    double max_y;
+    size_t count;
+};
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotPyramid
+//|
+//| DESCRIPTION:
+//|    This class maintains min/max buckets of a data set at power of two
+//|    resolutions. It is updated incrementally as points are appended so
+//|    that a zoomed out plot can be drawn from a few buckets per pixel
+//|    instead of every point.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotPyramid
+{
+    public:
+        wxTrendPlotPyramid(size_t capacity = 0);
+
+        // Remove all the buckets from the pyramid
+        void Clear(void);
+
+        // Add the next point of the data set. Points must be
+        // added in order of increasing x.
+        void AddPoint(double x, double y);
+
+        // The number of points added since the pyramid was cleared
+        wxUint64 GetPointCount(void) const
+        {
+            return m_points;
+        }
+
+        // Replace the finest bucket holding a point, numbered from the
+        // first point added, after a point in it has been changed.
+        // Buckets that start before the point numbered oldest are left
+        // alone.
+        void ReplaceBucket(wxUint64                 point,
+                           wxUint64                 oldest,
+                           const wxTrendPlotBucket& bucket);
+
+        // Find the coarsest level whose buckets summarise no
+        // more than the number of points specified.
+        int GetLevel(size_t points_per_bucket) const;
+
+        // The number of buckets in a level including the
+        // bucket that is still being filled.
+        size_t GetBucketCount(int level) const;
+
+        const wxTrendPlotBucket& GetBucket(int level, size_t index) const;
+
+        // Find the buckets needed to draw the range [start_x, end_x]
+        bool FindRange(int     level,
+                       double  start_x,
+                       double  end_x,
+                       size_t& first,
+                       size_t& last) const;
+
+        // Merge a bucket into the bucket preceding it
+        static void Merge(wxTrendPlotBucket& into, const wxTrendPlotBucket& from);
+
+    private:
+        struct Level
+        {
+            // The closed buckets stored as a ring buffer
+            std::vector<wxTrendPlotBucket> buckets;
+            size_t head;
+            size_t count;
+
+            // The number of points summarised by each bucket
+            size_t size;
+
+            // The bucket currently being filled
+            wxTrendPlotBucket open;
+        };
+
+        // Find a bucket of a level by its number, counting from the
+        // first bucket of the level. Returns NULL if it has been
+        // overwritten or hasn't been started.
+        wxTrendPlotBucket* FindBucket(size_t level, wxUint64 number);
+
+        std::vector<Level> m_levels;
+        wxUint64           m_points;
+};
+
+#endif // __TREND_PLOT_PYRAMID_H__
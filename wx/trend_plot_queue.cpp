@@ -0,0 +1,331 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_queue.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the queue used to pass
+//|    points to the trend plot from other threads.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <algorithm>
+#include <wx/utils.h>
+#include <wx/thread.h>
+
+#include "wx/trend_plot_queue.h"
+
+// The number of times a blocked producer yields before it
+// starts sleeping while it waits for room in the queue.
+#define TREND_PLOT_QUEUE_SPIN_COUNT 64
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotQueue()
+//|
+//| PARAMETERS:
+//|    capacity (I) - The number of points the queue can hold. This is
+//|                   rounded up to a power of two.
+//|    policy   (I) - What to do when the queue is full:
+//|                     TREND_PLOT_QUEUE_DROP_OLDEST
+//|                     TREND_PLOT_QUEUE_BLOCK
+//|    columns  (I) - The number of y co-ordinates in each frame.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the queue class. All the memory used
+//|    by the queue is allocated up front.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotQueue::wxTrendPlotQueue(size_t capacity,
+                                   int    policy,
+                                   size_t columns)
+{
+    size_t size = 2;
+
+    while(size < capacity)
+    {
+        size <<= 1;
+    }
+
+    if(columns < 1)
+    {
+        columns = 1;
+    }
+
+    std::vector<Cell> cells(size);
+    m_cells.swap(cells);
+    m_y.resize(size * columns);
+    m_columns = columns;
+    m_mask = size - 1;
+
+    // Each cell starts off ready to be written by the
+    // producer that reserves its position.
+    for(size_t index = 0; index < size; index++)
+    {
+        m_cells[index].sequence.Store((long)index);
+    }
+
+    m_enqueue_pos.Store(0);
+    m_dequeue_pos.Store(0);
+
+    m_policy.Store(policy);
+    m_closed.Store(0);
+    m_ready.Store(0);
+    m_dropped.Store(0);
+    m_refs.Store(0);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    TryPush()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the frame.
+//|    y (I) - The y co-ordinate of each column.
+//|
+//| FUNCTION:
+//|    This method reserves the next position in the queue and writes the
+//|    frame into it. The cell is handed to the consumer by bumping its
+//|    sequence number once the point has been written.
+//|
+//|    The positions are only compared as the difference between them so
+//|    that they can wrap around.
+//|
+//| RETURNS:
+//|    false if the queue is full, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotQueue::TryPush(double x, const double* y)
+{
+    long position = m_enqueue_pos.Load();
+    Cell* cell;
+
+    for(;;)
+    {
+        cell = &m_cells[position & m_mask];
+
+        long sequence = cell->sequence.Load();
+        long difference = (long)((unsigned long)sequence - (unsigned long)position);
+
+        if(difference == 0)
+        {
+            if(m_enqueue_pos.CompareExchange(position, (long)((unsigned long)position + 1)))
+            {
+                break;
+            }
+        }
+        else if(difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = m_enqueue_pos.Load();
+        }
+    }
+
+    cell->x = x;
+    std::copy(y, y + m_columns, m_y.begin() + ((position & m_mask) * m_columns));
+    cell->sequence.Store((long)((unsigned long)position + 1));
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Push()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the frame.
+//|    y (I) - The y co-ordinate of each column.
+//|
+//| FUNCTION:
+//|    This method is called from any thread to add a frame to the queue.
+//|    The first frame pushed after the GUI thread has emptied the queue
+//|    wakes it up so that the frames get added to the plot.
+//|
+//| RETURNS:
+//|    false if the queue has been closed, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotQueue::Push(double x, const double* y)
+{
+    int spins = 0;
+
+    for(;;)
+    {
+        if(m_closed.Load())
+        {
+            m_dropped.FetchAdd(1);
+            return false;
+        }
+
+        if(TryPush(x, y))
+        {
+            break;
+        }
+
+        if(m_policy.Load() == TREND_PLOT_QUEUE_DROP_OLDEST)
+        {
+            // Make room by throwing away the oldest frame
+            double old_x;
+
+            if(PopFrame(old_x, NULL))
+            {
+                m_dropped.FetchAdd(1);
+            }
+        }
+        else if(spins < TREND_PLOT_QUEUE_SPIN_COUNT)
+        {
+            // Wait for the GUI thread to empty the queue
+            wxThread::Yield();
+            spins++;
+        }
+        else
+        {
+            wxMilliSleep(1);
+        }
+    }
+
+    if(!m_ready.Load() && !m_ready.Exchange(1))
+    {
+        wxWakeUpIdle();
+    }
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    PopFrame()
+//|
+//| PARAMETERS:
+//|    x (O) - The x co-ordinate of the frame.
+//|    y (O) - The y co-ordinate of each column, or NULL to throw the
+//|            frame away.
+//|
+//| FUNCTION:
+//|    This method takes the oldest frame off the queue. The cell is
+//|    handed back to the producers by moving its sequence number on by
+//|    the size of the queue.
+//|
+//| RETURNS:
+//|    false if the queue is empty, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotQueue::PopFrame(double& x, double* y)
+{
+    long position = m_dequeue_pos.Load();
+    Cell* cell;
+
+    for(;;)
+    {
+        cell = &m_cells[position & m_mask];
+
+        long sequence = cell->sequence.Load();
+        long difference = (long)((unsigned long)sequence - ((unsigned long)position + 1));
+
+        if(difference == 0)
+        {
+            if(m_dequeue_pos.CompareExchange(position, (long)((unsigned long)position + 1)))
+            {
+                break;
+            }
+        }
+        else if(difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = m_dequeue_pos.Load();
+        }
+    }
+
+    x = cell->x;
+
+    if(y != NULL)
+    {
+        std::vector<double>::const_iterator first = m_y.begin() + ((position & m_mask) * m_columns);
+
+        std::copy(first, first + m_columns, y);
+    }
+
+    cell->sequence.Store((long)((unsigned long)position + m_mask + 1));
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Pop()
+//|
+//| PARAMETERS:
+//|    x     (O) - The x co-ordinates of the frames.
+//|    y     (O) - The y co-ordinates of the frames, one for each column
+//|                followed by the next frame and so on.
+//|    count (I) - The most frames to pop.
+//|
+//| FUNCTION:
+//|    This method takes a block of the oldest frames off the queue, in
+//|    the layout used to add frames to the plot.
+//|
+//| RETURNS:
+//|    The number of frames popped.
+//|
+//+------------------------------------------------------------------------------
+size_t wxTrendPlotQueue::Pop(double* x, double* y, size_t count)
+{
+    size_t popped = 0;
+
+    while(popped < count && PopFrame(x[popped], y + (popped * m_columns)))
+    {
+        popped++;
+    }
+
+    return popped;
+}
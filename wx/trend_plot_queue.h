@@ -0,0 +1,166 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_queue.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the queue used to pass points
+//|    to the trend plot from other threads.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_QUEUE_H__
+#define __TREND_PLOT_QUEUE_H__
+
+#include <vector>
+
+#include "wx/trend_plot_atomic.h"
+#include "wx/trend_plot_ref.h"
+
+// The default number of points a queue can hold before the
+// overflow policy kicks in.
+#define TREND_PLOT_DEFAULT_QUEUE_CAPACITY 4096
+
+// What happens when a point is pushed onto a full queue
+#define TREND_PLOT_QUEUE_DROP_OLDEST 0
+#define TREND_PLOT_QUEUE_BLOCK       1
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotQueue
+//|
+//| DESCRIPTION:
+//|    This class is a bounded lock-free queue of points. Any number of
+//|    threads can push points onto it while the GUI thread pops them off
+//|    and adds them to the plot. The queue is a ring of cells that each
+//|    carry a sequence number saying whether they are ready to be written
+//|    or read, so producers and the consumer only contend on the cell
+//|    they are using.
+//|
+//|    Each cell holds a frame: an x co-ordinate and a y co-ordinate for
+//|    each column of the queue. A queue for a single data set has one
+//|    column and a queue for a frame group has a column for each of its
+//|    data sets.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotQueue
+{
+    public:
+        wxTrendPlotQueue(size_t capacity = TREND_PLOT_DEFAULT_QUEUE_CAPACITY,
+                         int    policy = TREND_PLOT_QUEUE_DROP_OLDEST,
+                         size_t columns = 1);
+
+        // Push a point onto a queue with a single column. This can be
+        // called from any thread. If the queue is full the oldest point
+        // is dropped or the caller waits for room depending on the
+        // policy.
+        bool Push(double x, double y)
+        {
+            return Push(x, &y);
+        }
+
+        // Push a frame onto the queue, with a y for each column
+        bool Push(double x, const double* y);
+
+        // Pop up to count of the oldest frames off the queue into x
+        // and y, which has room for count times the columns. Returns
+        // the number of frames popped.
+        size_t Pop(double* x, double* y, size_t count);
+
+        size_t GetColumnCount(void) const
+        {
+            return m_columns;
+        }
+
+        // Set the policy used when the queue is full
+        void SetPolicy(int policy)
+        {
+            m_policy.Store(policy);
+        }
+
+        int GetPolicy(void) const
+        {
+            return m_policy.Load();
+        }
+
+        // The number of points that have been dropped because the
+        // queue was full or closed.
+        unsigned long GetDropped(void) const
+        {
+            return (unsigned long)m_dropped.Load();
+        }
+
+        size_t GetCapacity(void) const
+        {
+            return m_mask + 1;
+        }
+
+        // Stop accepting points. Called when the data set the
+        // queue belongs to is removed from the plot.
+        void Close(void)
+        {
+            m_closed.Store(1);
+        }
+
+        bool IsClosed(void) const
+        {
+            return m_closed.Load() != 0;
+        }
+
+        // Clear the flag set when points are pushed. Returns true if
+        // it was set.
+        bool TakeReady(void)
+        {
+            return m_ready.Exchange(0) != 0;
+        }
+
+        // Called by wxTrendPlotQueuePtr, which can be copied
+        // between threads.
+        void AddRef(void)
+        {
+            m_refs.FetchAdd(1);
+        }
+
+        bool Release(void)
+        {
+            return m_refs.FetchAdd(-1) == 1;
+        }
+
+    private:
+        bool TryPush(double x, const double* y);
+        bool PopFrame(double& x, double* y);
+
+        struct Cell
+        {
+            wxTrendPlotAtomic sequence;
+            double x;
+        };
+
+        // The y co-ordinates of the frame in each cell are kept
+        // together, columns at a time.
+        std::vector<Cell>   m_cells;
+        std::vector<double> m_y;
+        size_t              m_columns;
+        size_t              m_mask;
+
+        // Keep the positions of the producers and consumer on
+        // separate cache lines.
+        char m_pad0[64];
+        wxTrendPlotAtomic m_enqueue_pos;
+        char m_pad1[64];
+        wxTrendPlotAtomic m_dequeue_pos;
+        char m_pad2[64];
+
+        wxTrendPlotAtomic m_policy;
+        wxTrendPlotAtomic m_closed;
+        wxTrendPlotAtomic m_ready;
+        wxTrendPlotAtomic m_dropped;
+        wxTrendPlotAtomic m_refs;
+};
+
+typedef wxTrendPlotRef<wxTrendPlotQueue> wxTrendPlotQueuePtr;
+
+#endif // __TREND_PLOT_QUEUE_H__
@@ -0,0 +1,369 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_range.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the class used to track the
+//|    range of the visible points of a trend plot data set.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <algorithm>
+
+#include "wx/trend_plot_range.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotRange()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the range class. The window is empty
+//|    until the first update.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotRange::wxTrendPlotRange(void)
+{
+    Reset();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Reset()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method empties the window so that the next update starts
+//|    again from the frames held by the frame group.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotRange::Reset(void)
+{
+    m_min.clear();
+    m_max.clear();
+
+    m_group = NULL;
+    m_revision = 0;
+    m_replaced = 0;
+    m_start_x = 0;
+    m_end_x = 0;
+    m_pulled = false;
+    m_last_x = 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Update()
+//|
+//| PARAMETERS:
+//|    group   (I) - The frame group holding the points.
+//|    column  (I) - The column of the data set.
+//|    start_x (I) - The start of the window.
+//|    end_x   (I) - The end of the window.
+//|
+//| FUNCTION:
+//|    This method slides the window forward to [start_x, end_x]. The
+//|    frames newer than the last one pulled in that now fall inside the
+//|    window are added to the back of the queues, and the points that
+//|    have fallen off the start are dropped from the front. Only when
+//|    there are new frames does it have to search for them. Frames that
+//|    have been replaced in place are updated one at a time. If the
+//|    window has moved backwards or shrunk, or the frames in it have
+//|    been changed in a way that can't be followed, the queues are
+//|    filled again from scratch.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotRange::Update(const wxTrendPlotFrameGroup& group,
+                              const wxTrendPlotColumn*     column,
+                              double                       start_x,
+                              double                       end_x)
+{
+    if(&group != m_group ||
+       group.GetRevision() != m_revision ||
+       start_x < m_start_x ||
+       end_x < m_end_x ||
+       !ReplaceFrames(group, column))
+    {
+        Reset();
+
+        m_group = &group;
+        m_revision = group.GetRevision();
+        m_replaced = group.GetReplacedCount();
+    }
+    else if(m_pulled && start_x > m_last_x)
+    {
+        // Any frames between the last one pulled in and the
+        // start of the window are already out of it.
+        m_pulled = false;
+    }
+
+    m_start_x = start_x;
+    m_end_x = end_x;
+
+    size_t count = group.GetCount();
+    size_t first;
+    size_t last;
+    double from_x = m_pulled ? m_last_x : start_x;
+
+    if(count != 0 &&
+       IsPending(group.GetX(count - 1)) &&
+       from_x <= end_x &&
+       group.FindRange(from_x, end_x, first, last))
+    {
+        for(size_t index = first; index < last; index++)
+        {
+            double x = group.GetX(index);
+
+            if(x > end_x)
+            {
+                break;
+            }
+
+            if(IsPending(x))
+            {
+                Push(x, group.GetY(column, index));
+                m_pulled = true;
+                m_last_x = x;
+            }
+        }
+    }
+
+    while(!m_min.empty() && m_min.front().x < start_x)
+    {
+        m_min.pop_front();
+    }
+
+    while(!m_max.empty() && m_max.front().x < start_x)
+    {
+        m_max.pop_front();
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ReplaceFrames()
+//|
+//| PARAMETERS:
+//|    group  (I) - The frame group holding the points.
+//|    column (I) - The column of the data set.
+//|
+//| FUNCTION:
+//|    This method catches up with the frames the group has replaced
+//|    since the last update. Frames that haven't been pulled into the
+//|    window yet are picked up as usual and frames that have slid out
+//|    of it don't matter, so only the frames in between are put into
+//|    the queues.
+//|
+//| RETURNS:
+//|    false if the group has replaced more frames than it remembers or
+//|    a replaced frame can't be put into the queues, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotRange::ReplaceFrames(const wxTrendPlotFrameGroup& group,
+                                     const wxTrendPlotColumn*     column)
+{
+    wxUint64 count = group.GetReplacedCount();
+
+    if(count - m_replaced > TREND_PLOT_REPLACED_LOG_SIZE)
+    {
+        return false;
+    }
+
+    for(; m_replaced < count; m_replaced++)
+    {
+        double x = group.GetReplacedX(m_replaced);
+        size_t first;
+        size_t last;
+
+        if(x < m_start_x ||
+           IsPending(x) ||
+           !group.FindRange(x, x, first, last))
+        {
+            continue;
+        }
+
+        for(size_t index = first; index < last; index++)
+        {
+            if(group.GetX(index) != x)
+            {
+                continue;
+            }
+
+            double y = group.GetY(column, index);
+
+            if(!ReplacePoint(m_min, x, y, 1) ||
+               !ReplacePoint(m_max, x, y, -1))
+            {
+                return false;
+            }
+
+            break;
+        }
+    }
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    ReplacePoint()
+//|
+//| PARAMETERS:
+//|    queue (IO) - The queue of the minimum or maximum.
+//|    x     (I)  - The x co-ordinate of the point.
+//|    y     (I)  - The new y co-ordinate of the point.
+//|    sign  (I)  - 1 for the minimum and -1 for the maximum, so that
+//|                 a smaller sign * y is always better.
+//|
+//| FUNCTION:
+//|    This method puts a changed point into a queue as if it had been
+//|    pushed in its place. If the old point is still queued it is taken
+//|    out, which is only safe if the new point is at least as good since
+//|    it then beats every point the old one did. The new point is left
+//|    out if a later point beats it, otherwise the earlier points it
+//|    beats are dropped and it is queued in their place.
+//|
+//| RETURNS:
+//|    false if the old point was queued and the new point is worse, in
+//|    which case the points it had beaten are needed again, true
+//|    otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotRange::ReplacePoint(std::deque<Point>& queue, double x, double y, double sign)
+{
+    std::deque<Point>::iterator at = std::lower_bound(queue.begin(), queue.end(), x, IsBefore);
+
+    if(at != queue.end() && at->x == x)
+    {
+        // This also catches the point becoming a gap
+        if(!(sign * y <= sign * at->y))
+        {
+            return false;
+        }
+
+        at = queue.erase(at);
+    }
+
+    if(y != y || (at != queue.end() && sign * at->y <= sign * y))
+    {
+        return true;
+    }
+
+    std::deque<Point>::iterator from = at;
+
+    while(from != queue.begin() && sign * (from - 1)->y >= sign * y)
+    {
+        --from;
+    }
+
+    Point point;
+    point.x = x;
+    point.y = y;
+
+    at = queue.erase(from, at);
+    queue.insert(at, point);
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Push()
+//|
+//| PARAMETERS:
+//|    x (I) - The x co-ordinate of the point.
+//|    y (I) - The y co-ordinate of the point.
+//|
+//| FUNCTION:
+//|    This method adds a point to the back of the queues. The points it
+//|    beats can never be the minimum or maximum again while it is in the
+//|    window, so they are dropped first. That leaves each queue sorted,
+//|    with the answer at the front.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotRange::Push(double x, double y)
+{
+    // A gap in the data doesn't have a range
+    if(y != y)
+    {
+        return;
+    }
+
+    Point point;
+    point.x = x;
+    point.y = y;
+
+    while(!m_min.empty() && m_min.back().y >= y)
+    {
+        m_min.pop_back();
+    }
+
+    m_min.push_back(point);
+
+    while(!m_max.empty() && m_max.back().y <= y)
+    {
+        m_max.pop_back();
+    }
+
+    m_max.push_back(point);
+}
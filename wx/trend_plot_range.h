@@ -0,0 +1,121 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_range.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the class used to track the
+//|    range of the visible points of a trend plot data set.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_RANGE_H__
+#define __TREND_PLOT_RANGE_H__
+
+#include <deque>
+#include <wx/defs.h>
+
+#include "wx/trend_plot_frame_group.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotRange
+//|
+//| DESCRIPTION:
+//|    This class keeps the minimum and maximum y of the points of a data
+//|    set inside a window of x that slides forward. Each is kept as a
+//|    monotonic queue: a point is only queued once every point before it
+//|    that it beats has been dropped from the back, so the front is the
+//|    answer and each point is queued and dropped at most once. Points
+//|    that have arrived since the last update are pulled in from the
+//|    frame group and points that have slid out of the window are dropped
+//|    from the front, so keeping up costs a constant time per point.
+//|
+//|    The points are copied into the queues so the window still covers
+//|    points that the frame group has since evicted. Frames replaced in
+//|    place are put into the queues in their place, unless that makes a
+//|    point at the front of a queue worse. That, moving the window
+//|    backwards or changing the frames already in it in any other way
+//|    means starting again from the frames the group holds.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotRange
+{
+    public:
+        wxTrendPlotRange(void);
+
+        // Slide the window to [start_x, end_x] over the points of a
+        // column of a frame group.
+        void Update(const wxTrendPlotFrameGroup& group,
+                    const wxTrendPlotColumn*     column,
+                    double                       start_x,
+                    double                       end_x);
+
+        // Forget the points so far
+        void Reset(void);
+
+        bool IsEmpty(void) const
+        {
+            return m_min.empty();
+        }
+
+        // The smallest and largest y in the window. These are only
+        // valid if the window isn't empty.
+        double GetMin(void) const
+        {
+            return m_min.front().y;
+        }
+
+        double GetMax(void) const
+        {
+            return m_max.front().y;
+        }
+
+    private:
+        struct Point
+        {
+            double x;
+            double y;
+        };
+
+        void Push(double x, double y);
+
+        // Put the frames the group has replaced since the last update
+        // into the queues. Returns false if they have to be filled again.
+        bool ReplaceFrames(const wxTrendPlotFrameGroup& group,
+                           const wxTrendPlotColumn*     column);
+
+        // Put a point into a queue in place of the point with the same
+        // x. The sign is 1 for the minimum and -1 for the maximum.
+        static bool ReplacePoint(std::deque<Point>& queue, double x, double y, double sign);
+
+        // Whether a frame is still to be pulled into the window. Until
+        // one has been pulled in they are taken from the start of the
+        // window, and after that from the last one pulled in.
+        bool IsPending(double x) const
+        {
+            return m_pulled ? x > m_last_x : x >= m_start_x;
+        }
+
+        static bool IsBefore(const Point& point, double x)
+        {
+            return point.x < x;
+        }
+
+        std::deque<Point> m_min;
+        std::deque<Point> m_max;
+
+        // The window and the frames that have been pulled into it
+        const wxTrendPlotFrameGroup* m_group;
+        wxUint64                     m_revision;
+        wxUint64                     m_replaced;
+        double                       m_start_x;
+        double                       m_end_x;
+        bool                         m_pulled;
+        double                       m_last_x;
+};
+
+#endif // __TREND_PLOT_RANGE_H__
@@ -0,0 +1,129 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_ref.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the pointer used to share the
+//|    parts of a trend plot that have more than one owner.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_REF_H__
+#define __TREND_PLOT_REF_H__
+
+#include <cstddef>
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotRef
+//|
+//| DESCRIPTION:
+//|    This class is a pointer to an object that keeps its own count of
+//|    references. The object is deleted when the last pointer to it goes.
+//|    The object class provides AddRef() and Release(), which returns
+//|    true when the count drops to 0, so it decides whether the count
+//|    has to be safe to change from several threads.
+//|
+//+------------------------------------------------------------------------------
+template <class T>
+class wxTrendPlotRef
+{
+    public:
+        // Take a reference to an object, which may have just been
+        // created with a count of 0.
+        wxTrendPlotRef(T* object = NULL)
+        {
+            m_object = object;
+            AddRef();
+        }
+
+        wxTrendPlotRef(const wxTrendPlotRef& other)
+        {
+            m_object = other.m_object;
+            AddRef();
+        }
+
+        ~wxTrendPlotRef(void)
+        {
+            Release();
+        }
+
+        wxTrendPlotRef& operator=(const wxTrendPlotRef& other)
+        {
+            // Take the new reference first in case it is the same object
+            T* object = other.m_object;
+
+            if(object != NULL)
+            {
+                object->AddRef();
+            }
+
+            Release();
+            m_object = object;
+
+            return *this;
+        }
+
+        // Point at another object
+        void Reset(T* object = NULL)
+        {
+            *this = wxTrendPlotRef(object);
+        }
+
+        T* Get(void) const
+        {
+            return m_object;
+        }
+
+        bool IsOk(void) const
+        {
+            return m_object != NULL;
+        }
+
+        T* operator->(void) const
+        {
+            return m_object;
+        }
+
+        T& operator*(void) const
+        {
+            return *m_object;
+        }
+
+        bool operator==(const wxTrendPlotRef& other) const
+        {
+            return m_object == other.m_object;
+        }
+
+        bool operator!=(const wxTrendPlotRef& other) const
+        {
+            return m_object != other.m_object;
+        }
+
+    private:
+        void AddRef(void)
+        {
+            if(m_object != NULL)
+            {
+                m_object->AddRef();
+            }
+        }
+
+        void Release(void)
+        {
+            if(m_object != NULL && m_object->Release())
+            {
+                delete m_object;
+            }
+
+            m_object = NULL;
+        }
+
+        T* m_object;
+};
+
+#endif // __TREND_PLOT_REF_H__
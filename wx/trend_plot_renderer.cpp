@@ -0,0 +1,363 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_renderer.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the thread used to draw the
+//|    frames of a trend plot off the GUI thread.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <algorithm>
+
+#include "wx/trend_plot_renderer.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotRenderer()
+//|
+//| PARAMETERS:
+//|    tiles (I) - The pool of threads the lines are drawn with.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the renderer class. The thread is
+//|    joinable so that the plot can wait for it to finish before the
+//|    surfaces it draws into are destroyed.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotRenderer::wxTrendPlotRenderer(wxTrendPlotTilePool* tiles)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_condition(m_mutex)
+{
+    m_tiles = tiles;
+    m_stop = false;
+    m_submitted = false;
+
+    for(int frame = 0; frame < TREND_PLOT_RENDER_FRAMES; frame++)
+    {
+        m_frames[frame] = NULL;
+    }
+
+    m_back = 0;
+    m_ready = 1;
+    m_front = 2;
+    m_fresh = false;
+
+    m_measure_surface = NULL;
+    m_measure = NULL;
+}
+
+
+wxTrendPlotRenderer::~wxTrendPlotRenderer(void)
+{
+    // Release the chrome before the surfaces it may be similar to
+    m_pending.ReleaseChrome();
+    m_scene.ReleaseChrome();
+
+    for(int frame = 0; frame < TREND_PLOT_RENDER_FRAMES; frame++)
+    {
+        if(m_frames[frame] != NULL)
+        {
+            cairo_surface_destroy(m_frames[frame]);
+        }
+    }
+
+    if(m_measure != NULL)
+    {
+        cairo_destroy(m_measure);
+        cairo_surface_destroy(m_measure_surface);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Start()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method creates and starts the thread.
+//|
+//| RETURNS:
+//|    false if the thread couldn't be started.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotRenderer::Start(void)
+{
+    if(!m_condition.IsOk() || Create() != wxTHREAD_NO_ERROR)
+    {
+        return false;
+    }
+
+    return Run() == wxTHREAD_NO_ERROR;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Stop()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method asks the thread to finish once it has drawn the frame
+//|    it is working on and waits for it. Any scene still waiting is
+//|    thrown away.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotRenderer::Stop(void)
+{
+    {
+        wxMutexLocker lock(m_mutex);
+
+        m_stop = true;
+        m_condition.Signal();
+    }
+
+    Wait();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetContext()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method returns a cairo context on a small image surface of the
+//|    same format as the frames. Surfaces created similar to its target
+//|    are image surfaces that the thread can read from safely, and text
+//|    measured with it has the same size as when the thread draws it.
+//|    It must only be used on the GUI thread.
+//|
+//| RETURNS:
+//|    The cairo context.
+//|
+//+------------------------------------------------------------------------------
+cairo_t* wxTrendPlotRenderer::GetContext(void)
+{
+    if(m_measure == NULL)
+    {
+        m_measure_surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, 1, 1);
+        m_measure = cairo_create(m_measure_surface);
+    }
+
+    return m_measure;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Submit()
+//|
+//| PARAMETERS:
+//|    scene (I/O) - The scene to draw. It is swapped for an older scene.
+//|
+//| FUNCTION:
+//|    This method hands a scene to the thread. If the thread hasn't got
+//|    round to the last scene submitted then that scene is replaced, so
+//|    the thread never falls behind the GUI.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotRenderer::Submit(wxTrendPlotScene& scene)
+{
+    wxMutexLocker lock(m_mutex);
+
+    m_pending.Swap(scene);
+    m_submitted = true;
+    m_condition.Signal();
+}
+
+
+bool wxTrendPlotRenderer::IsFresh(void)
+{
+    wxMutexLocker lock(m_mutex);
+
+    return m_fresh;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    TakeFrame()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method swaps the newest finished frame to the front, if there
+//|    is one that hasn't been taken yet. Otherwise the frame taken last
+//|    time is returned again.
+//|
+//| RETURNS:
+//|    The front frame, or NULL if no frame has been finished yet.
+//|
+//+------------------------------------------------------------------------------
+cairo_surface_t* wxTrendPlotRenderer::TakeFrame(void)
+{
+    wxMutexLocker lock(m_mutex);
+
+    if(m_fresh)
+    {
+        std::swap(m_front, m_ready);
+        m_fresh = false;
+    }
+
+    return m_frames[m_front];
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Entry()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This is the body of the thread. It waits for a scene, draws it into
+//|    the back frame without holding the lock and then publishes the
+//|    frame and wakes up the GUI thread to show it.
+//|
+//| RETURNS:
+//|    0.
+//|
+//+------------------------------------------------------------------------------
+wxThread::ExitCode wxTrendPlotRenderer::Entry(void)
+{
+    m_mutex.Lock();
+
+    for(;;)
+    {
+        while(!m_stop && !m_submitted)
+        {
+            m_condition.Wait();
+        }
+
+        if(m_stop)
+        {
+            break;
+        }
+
+        m_scene.Swap(m_pending);
+        m_submitted = false;
+
+        m_mutex.Unlock();
+        Render();
+        m_mutex.Lock();
+
+        std::swap(m_back, m_ready);
+        m_fresh = true;
+
+        wxWakeUpIdle();
+    }
+
+    m_mutex.Unlock();
+
+    return 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Render()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method draws the current scene into the back frame, which is
+//|    re-created if it isn't the size of the scene. The lines are drawn
+//|    in tiles if the tile pool can split them up.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotRenderer::Render(void)
+{
+    const wxRect& rect = m_scene.GetRect();
+    cairo_surface_t*& frame = m_frames[m_back];
+
+    if(frame != NULL &&
+       (cairo_image_surface_get_width(frame) != rect.width ||
+        cairo_image_surface_get_height(frame) != rect.height))
+    {
+        cairo_surface_destroy(frame);
+        frame = NULL;
+    }
+
+    if(frame == NULL)
+    {
+        frame = cairo_image_surface_create(CAIRO_FORMAT_RGB24, rect.width, rect.height);
+    }
+
+    cairo_t* cairo_image = cairo_create(frame);
+
+    m_scene.DrawBackground(cairo_image);
+
+    if(!m_tiles->DrawLines(m_scene, cairo_image))
+    {
+        m_scene.DrawLines(cairo_image);
+    }
+
+    m_scene.DrawForeground(cairo_image);
+
+    cairo_destroy(cairo_image);
+    cairo_surface_flush(frame);
+}
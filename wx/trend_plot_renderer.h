@@ -0,0 +1,111 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_renderer.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the thread used to draw the
+//|    frames of a trend plot off the GUI thread.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_RENDERER_H__
+#define __TREND_PLOT_RENDERER_H__
+
+#include <cairo.h>
+#include <wx/thread.h>
+
+#include "wx/trend_plot_scene.h"
+#include "wx/trend_plot_tiles.h"
+
+// The number of frames the thread and the GUI pass between them
+#define TREND_PLOT_RENDER_FRAMES 3
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotRenderer
+//|
+//| DESCRIPTION:
+//|    This class is a thread that draws trend plot scenes into cairo image
+//|    surfaces. The GUI thread submits a scene whenever the plot changes
+//|    and carries on; if the thread is still busy with the last one only
+//|    the newest scene waiting is drawn.
+//|
+//|    Finished frames are passed back through a triple buffer. The thread
+//|    draws into the back frame, then swaps it with the ready frame and
+//|    wakes up the GUI thread, which swaps the ready frame with the front
+//|    frame it shows. Neither side ever waits for the other to finish
+//|    drawing or showing a frame, only for the swap itself.
+//|
+//|    The lines of each frame can be shared out between the threads of a
+//|    tile pool, which the thread uses while drawing a frame.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotRenderer : public wxThread
+{
+    public:
+        // The lines are drawn in tiles if the pool has any threads
+        wxTrendPlotRenderer(wxTrendPlotTilePool* tiles);
+
+        ~wxTrendPlotRenderer(void);
+
+        // Start the thread
+        bool Start(void);
+
+        // Ask the thread to finish and wait for it
+        void Stop(void);
+
+        // A context on a surface like the frames, which the GUI thread
+        // can use to create the static parts of the plot and measure
+        // text with.
+        cairo_t* GetContext(void);
+
+        // Pass a scene to the thread to be drawn. The scene is swapped
+        // with an old one that can be rebuilt for the next frame.
+        void Submit(wxTrendPlotScene& scene);
+
+        // Whether a frame has been finished since the last call to
+        // TakeFrame().
+        bool IsFresh(void);
+
+        // Get the newest finished frame, or NULL if no frame has been
+        // finished yet. It belongs to the GUI thread until the next
+        // call.
+        cairo_surface_t* TakeFrame(void);
+
+    protected:
+        virtual ExitCode Entry(void);
+
+    private:
+        void Render(void);
+
+        wxMutex     m_mutex;
+        wxCondition m_condition;
+        bool        m_stop;
+
+        // The newest scene submitted and the scene being drawn
+        wxTrendPlotScene m_pending;
+        bool             m_submitted;
+        wxTrendPlotScene m_scene;
+
+        // Draws the lines in parallel
+        wxTrendPlotTilePool* m_tiles;
+
+        // The back frame is drawn by the thread, the front frame is
+        // shown by the GUI thread and the ready frame is the newest
+        // one finished.
+        cairo_surface_t* m_frames[TREND_PLOT_RENDER_FRAMES];
+        int              m_back;
+        int              m_ready;
+        int              m_front;
+        bool             m_fresh;
+
+        // Used by the GUI thread to measure text
+        cairo_surface_t* m_measure_surface;
+        cairo_t*         m_measure;
+};
+
+#endif // __TREND_PLOT_RENDERER_H__
@@ -0,0 +1,671 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_scene.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the class used to describe
+//|    a frame of a trend plot ready to be drawn on any thread.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <algorithm>
+
+#include "wx/trend_plot_decimator.h"
+#include "wx/trend_plot_scene.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetOutCode()
+//|
+//| PARAMETERS:
+//|    point (I) - The point in screen co-ordinates.
+//|    area  (I) - The area of the graph.
+//|
+//| FUNCTION:
+//|    This method works out which sides of the graph a point falls
+//|    outside of. If the codes of both ends of a line have a side in
+//|    common then the whole line is outside of the graph and doesn't
+//|    need to be drawn. The point put in a decimated line where there is
+//|    a gap in the data has a code of its own.
+//|
+//| RETURNS:
+//|    A combination of the OUTCODE_ flags, 0 if the point is inside.
+//|
+//+------------------------------------------------------------------------------
+int wxTrendPlotScene::GetOutCode(const wxPoint& point, const wxRect& area)
+{
+    int code = 0;
+
+    if(point.y == TREND_PLOT_GAP_Y)
+    {
+        return OUTCODE_GAP;
+    }
+
+    if(point.x < area.GetLeft())
+    {
+        code |= OUTCODE_LEFT;
+    }
+    else if(point.x > area.GetRight())
+    {
+        code |= OUTCODE_RIGHT;
+    }
+
+    if(point.y < area.GetTop())
+    {
+        code |= OUTCODE_TOP;
+    }
+    else if(point.y > area.GetBottom())
+    {
+        code |= OUTCODE_BOTTOM;
+    }
+
+    return code;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotScene()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the scene class. The scene is empty
+//|    until it is built.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotScene::wxTrendPlotScene(void)
+{
+    m_chrome = NULL;
+    m_clip = true;
+    m_label_y = 0;
+    m_paused = false;
+    m_tick_count = 0;
+    m_line_count = 0;
+}
+
+
+wxTrendPlotScene::~wxTrendPlotScene(void)
+{
+    ReleaseChrome();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Swap()
+//|
+//| PARAMETERS:
+//|    other (I/O) - The scene to exchange contents with.
+//|
+//| FUNCTION:
+//|    This method exchanges the contents of two scenes. It is used to hand
+//|    scenes between threads, so it mustn't allocate any memory.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::Swap(wxTrendPlotScene& other)
+{
+    std::swap(m_rect, other.m_rect);
+    std::swap(m_chrome, other.m_chrome);
+    std::swap(m_graph, other.m_graph);
+    std::swap(m_clip, other.m_clip);
+    std::swap(m_label_y, other.m_label_y);
+    std::swap(m_paused, other.m_paused);
+    m_zoom.swap(other.m_zoom);
+
+    m_ticks.swap(other.m_ticks);
+    std::swap(m_tick_count, other.m_tick_count);
+    m_lines.swap(other.m_lines);
+    std::swap(m_line_count, other.m_line_count);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Begin()
+//|
+//| PARAMETERS:
+//|    rect   (I) - The client area of the plot.
+//|    chrome (I) - The static parts of the plot, the same size as rect.
+//|    graph  (I) - The area of the graph the lines are drawn in.
+//|    clip   (I) - Set to clip the lines to the graph.
+//|
+//| FUNCTION:
+//|    This method starts building a new scene. The scene takes its own
+//|    reference to the chrome, so the plot is free to replace its copy
+//|    while the scene is being drawn.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::Begin(const wxRect&    rect,
+                             cairo_surface_t* chrome,
+                             const wxRect&    graph,
+                             bool             clip)
+{
+    if(chrome != m_chrome)
+    {
+        ReleaseChrome();
+
+        if(chrome != NULL)
+        {
+            m_chrome = cairo_surface_reference(chrome);
+        }
+    }
+
+    m_rect = rect;
+    m_graph = graph;
+    m_clip = clip;
+    m_label_y = rect.y + rect.height;
+    m_paused = false;
+    m_zoom.clear();
+    m_tick_count = 0;
+    m_line_count = 0;
+}
+
+
+void wxTrendPlotScene::ReleaseChrome(void)
+{
+    if(m_chrome != NULL)
+    {
+        cairo_surface_destroy(m_chrome);
+        m_chrome = NULL;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddTick()
+//|
+//| PARAMETERS:
+//|    x     (I) - The screen x co-ordinate of the tick.
+//|    width (I) - The width of the label.
+//|    text  (I) - The label.
+//|
+//| FUNCTION:
+//|    This method adds a tick along the x axis to the scene. The label is
+//|    centred on the tick.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::AddTick(double x, double width, const std::string& text)
+{
+    if(m_tick_count == m_ticks.size())
+    {
+        m_ticks.push_back(wxTrendPlotSceneTick());
+    }
+
+    wxTrendPlotSceneTick& tick = m_ticks[m_tick_count++];
+
+    tick.x = x;
+    tick.width = width;
+    tick.text = text;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    AddLine()
+//|
+//| PARAMETERS:
+//|    red    (I) - The red component of the colour of the line.
+//|    green  (I) - The green component of the colour of the line.
+//|    blue   (I) - The blue component of the colour of the line.
+//|    points (I) - The points of the line in screen co-ordinates.
+//|
+//| FUNCTION:
+//|    This method copies the line of a data set into the scene. The
+//|    storage of the line that was in the same place in the last scene
+//|    is reused.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::AddLine(double                      red,
+                               double                      green,
+                               double                      blue,
+                               const std::vector<wxPoint>& points)
+{
+    if(m_line_count == m_lines.size())
+    {
+        m_lines.push_back(wxTrendPlotSceneLine());
+    }
+
+    wxTrendPlotSceneLine& line = m_lines[m_line_count++];
+
+    line.red = red;
+    line.green = green;
+    line.blue = blue;
+    line.points.assign(points.begin(), points.end());
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Draw()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to draw with.
+//|
+//| FUNCTION:
+//|    This method draws the whole scene. It only reads the scene, so it
+//|    can be called from any thread as long as the scene isn't being
+//|    built at the same time.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::Draw(cairo_t* cairo_image) const
+{
+    DrawBackground(cairo_image);
+    DrawLines(cairo_image);
+    DrawForeground(cairo_image);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrawBackground()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to draw with.
+//|
+//| FUNCTION:
+//|    This method starts the frame from the static parts of the plot and
+//|    draws the grid lines at the ticks along the x axis, which move as
+//|    the plot scrolls and so can't be part of the static parts.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::DrawBackground(cairo_t* cairo_image) const
+{
+    int min_x = m_graph.x;
+    int max_x = m_graph.x + m_graph.width;
+    int min_y = m_graph.y + m_graph.height;
+    int max_y = m_graph.y;
+
+    if(m_chrome != NULL)
+    {
+        cairo_set_source_surface(cairo_image, m_chrome, 0, 0);
+        cairo_paint(cairo_image);
+    }
+
+    cairo_set_line_width(cairo_image, 0.7);
+    cairo_set_source_rgb(cairo_image, 0xE0/256.0, 0xE0/256.0, 0xE0/256.0);
+
+    for(size_t tick = 0; tick < m_tick_count; tick++)
+    {
+        double x = m_ticks[tick].x;
+
+        if(x > min_x + 1 && x < max_x - 1)
+        {
+            cairo_move_to(cairo_image, x, max_y + 1);
+            cairo_line_to(cairo_image, x, min_y - 1);
+        }
+    }
+    cairo_stroke(cairo_image);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrawLines()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to draw with.
+//|
+//| FUNCTION:
+//|    This method draws the line of each data set. If the lines aren't
+//|    clipped to the graph then the parts of them outside of it are
+//|    hidden by restoring the area around the graph from the static
+//|    parts of the plot.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::DrawLines(cairo_t* cairo_image) const
+{
+    // Lines that are entirely outside of this area aren't drawn.
+    // It is a pixel bigger than the graph to allow for the width
+    // of the lines.
+    wxRect visible = m_graph;
+    visible.Inflate(1, 1);
+
+    // Only let the lines draw inside the graph
+    if(m_clip)
+    {
+        cairo_save(cairo_image);
+        cairo_rectangle(cairo_image,
+                        m_graph.x,
+                        m_graph.y,
+                        m_graph.width,
+                        m_graph.height);
+        cairo_clip(cairo_image);
+    }
+
+    cairo_set_line_width(cairo_image, 0.7);
+
+    for(size_t line = 0; line < m_line_count; line++)
+    {
+        cairo_set_source_rgb(cairo_image,
+                             m_lines[line].red,
+                             m_lines[line].green,
+                             m_lines[line].blue);
+
+        StrokeLine(cairo_image, m_lines[line].points, visible);
+    }
+
+    if(m_clip)
+    {
+        cairo_restore(cairo_image);
+    }
+    else
+    {
+        HideOverflow(cairo_image);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrawTile()
+//|
+//| PARAMETERS:
+//|    cairo_tile (I) - The cairo context to draw with. It is set up so
+//|                     that the tile is drawn in its place in the frame.
+//|    tile       (I) - The columns of the frame covered by the tile.
+//|
+//| FUNCTION:
+//|    This method draws the part of the line of each data set that falls
+//|    inside a tile. Each pixel of the tile ends up exactly as DrawLines()
+//|    would leave it, as long as the tile starts on a whole pixel and
+//|    the context maps it there with a whole pixel offset. The lines are
+//|    clipped to the tile on a pixel boundary and segments are only left
+//|    out if they are too far outside the tile for their joins or their
+//|    antialiasing to reach it.
+//|
+//|    Nothing is drawn outside of the tile, so the parts of the lines
+//|    outside of the graph still have to be hidden with HideOverflow()
+//|    once all of the tiles have been drawn.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::DrawTile(cairo_t* cairo_tile, const wxRect& tile) const
+{
+    // Leave out the segments DrawLines() would, and those that are
+    // too far to the side of the tile to touch it.
+    wxRect visible = m_graph;
+    visible.Inflate(1, 1);
+
+    int left = std::max(visible.x, tile.x - TREND_PLOT_TILE_MARGIN);
+    int right = std::min(visible.x + visible.width,
+                         tile.x + tile.width + TREND_PLOT_TILE_MARGIN);
+
+    if(right <= left)
+    {
+        return;
+    }
+
+    visible.x = left;
+    visible.width = right - left;
+
+    wxRect clip = tile;
+
+    if(m_clip)
+    {
+        clip.Intersect(m_graph);
+    }
+
+    if(clip.IsEmpty())
+    {
+        return;
+    }
+
+    cairo_save(cairo_tile);
+    cairo_rectangle(cairo_tile, clip.x, clip.y, clip.width, clip.height);
+    cairo_clip(cairo_tile);
+
+    cairo_set_line_width(cairo_tile, 0.7);
+
+    for(size_t line = 0; line < m_line_count; line++)
+    {
+        cairo_set_source_rgb(cairo_tile,
+                             m_lines[line].red,
+                             m_lines[line].green,
+                             m_lines[line].blue);
+
+        StrokeLine(cairo_tile, m_lines[line].points, visible);
+    }
+
+    cairo_restore(cairo_tile);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    HideOverflow()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to draw with.
+//|
+//| FUNCTION:
+//|    If the lines aren't clipped to the graph this method hides the
+//|    parts of them that were drawn outside of it by restoring the area
+//|    around the graph from the static parts of the plot.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::HideOverflow(cairo_t* cairo_image) const
+{
+    if(!m_clip && m_chrome != NULL)
+    {
+        cairo_set_source_surface(cairo_image, m_chrome, 0, 0);
+        cairo_rectangle(cairo_image,
+                        m_rect.x,
+                        m_rect.y,
+                        m_rect.width,
+                        m_rect.height);
+        cairo_rectangle(cairo_image,
+                        m_graph.x,
+                        m_graph.y,
+                        m_graph.width,
+                        m_graph.height);
+        cairo_set_fill_rule(cairo_image, CAIRO_FILL_RULE_EVEN_ODD);
+        cairo_fill(cairo_image);
+        cairo_set_fill_rule(cairo_image, CAIRO_FILL_RULE_WINDING);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrawForeground()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to draw with.
+//|
+//| FUNCTION:
+//|    This method draws the tick marks and labels along the x axis and
+//|    the status of the plot over the top of the lines.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::DrawForeground(cairo_t* cairo_image) const
+{
+    int min_y = m_graph.y + m_graph.height;
+
+    cairo_set_line_width(cairo_image, 0.7);
+    cairo_set_source_rgb (cairo_image,
+                          0xA0/256.0, 0xA0/256.0, 0xA0/256.0);
+
+    for(size_t tick = 0; tick < m_tick_count; tick++)
+    {
+        cairo_move_to(cairo_image, m_ticks[tick].x, min_y - 1);
+        cairo_line_to(cairo_image, m_ticks[tick].x, min_y + 5);
+    }
+    cairo_stroke(cairo_image);
+
+    cairo_select_font_face(cairo_image, "Times",
+                           CAIRO_FONT_SLANT_NORMAL,
+                           CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cairo_image, 11);
+    cairo_set_source_rgb (cairo_image,
+                          0, 0, 0);
+
+    for(size_t tick = 0; tick < m_tick_count; tick++)
+    {
+        cairo_move_to(cairo_image,
+                      m_ticks[tick].x - (m_ticks[tick].width / 2),
+                      m_label_y);
+        cairo_show_text (cairo_image, m_ticks[tick].text.c_str());
+    }
+
+    cairo_select_font_face(cairo_image, "Times",
+                           CAIRO_FONT_SLANT_NORMAL,
+                           CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size (cairo_image, 8 + 2);
+
+    cairo_set_source_rgb (cairo_image,
+                          0xA0/256.0,0xA0/256.0, 0xA0/256.0);
+    if(m_paused)
+    {
+        cairo_move_to(cairo_image, m_rect.width - 80, m_rect.y + 15);
+        cairo_show_text(cairo_image, "Paused");
+    }
+
+    if(!m_zoom.empty())
+    {
+        cairo_move_to(cairo_image, m_rect.width - 80, m_rect.y + 25);
+        cairo_show_text(cairo_image, m_zoom.c_str());
+        cairo_stroke(cairo_image);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    StrokeLine()
+//|
+//| PARAMETERS:
+//|    cairo_image (I) - The cairo context to draw with.
+//|    points      (I) - The points of the line in screen co-ordinates.
+//|    visible     (I) - Segments entirely outside of this area aren't
+//|                      drawn.
+//|
+//| FUNCTION:
+//|    This method builds the whole line as a single path so that cairo
+//|    only has to stroke it once. Any segments that are outside of the
+//|    visible area or that end at a gap in the data are left out of the
+//|    path.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotScene::StrokeLine(cairo_t*                    cairo_image,
+                                  const std::vector<wxPoint>& points,
+                                  const wxRect&               visible)
+{
+    if(points.empty())
+    {
+        return;
+    }
+
+    bool pen_down = false;
+    int last_code = GetOutCode(points[0], visible);
+
+    for(size_t point = 1; point < points.size(); point++)
+    {
+        int code = GetOutCode(points[point], visible);
+
+        if(IsHidden(code, last_code))
+        {
+            pen_down = false;
+        }
+        else
+        {
+            if(!pen_down)
+            {
+                cairo_move_to (cairo_image,
+                               points[point - 1].x,
+                               points[point - 1].y);
+                pen_down = true;
+            }
+
+            cairo_line_to (cairo_image,
+                           points[point].x,
+                           points[point].y);
+        }
+
+        last_code = code;
+    }
+    cairo_stroke (cairo_image);
+}
@@ -0,0 +1,200 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_scene.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the class used to describe a
+//|    frame of a trend plot once the data sets have been reduced to what
+//|    is on screen.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_SCENE_H__
+#define __TREND_PLOT_SCENE_H__
+
+#include <string>
+#include <vector>
+#include <cairo.h>
+#include <wx/gdicmn.h>
+
+// The sides of the graph a point can fall outside of
+#define OUTCODE_LEFT   0x1
+#define OUTCODE_RIGHT  0x2
+#define OUTCODE_TOP    0x4
+#define OUTCODE_BOTTOM 0x8
+
+// The code of the point that breaks a line where the data has a gap
+#define OUTCODE_GAP    0x10
+
+// How far outside of a tile a segment of a line has to be before it is
+// left out of the tile. This is further than a miter join or the
+// antialiasing of a line can reach.
+#define TREND_PLOT_TILE_MARGIN 8
+
+
+//+------------------------------------------------------------------------------
+//|
+//| STRUCTURE:
+//|    wxTrendPlotSceneLine
+//|
+//| DESCRIPTION:
+//|    This structure holds the line of a data set in screen co-ordinates
+//|    and the colour it is drawn in.
+//|
+//+------------------------------------------------------------------------------
+struct wxTrendPlotSceneLine
+{
+    double               red;
+    double               green;
+    double               blue;
+    std::vector<wxPoint> points;
+};
+
+
+//+------------------------------------------------------------------------------
+//|
+//| STRUCTURE:
+//|    wxTrendPlotSceneTick
+//|
+//| DESCRIPTION:
+//|    This structure holds a tick along the x axis and its label, which
+//|    has already been measured.
+//|
+//+------------------------------------------------------------------------------
+struct wxTrendPlotSceneTick
+{
+    double      x;
+    double      width;
+    std::string text;
+};
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotScene
+//|
+//| DESCRIPTION:
+//|    This class holds everything needed to draw a frame of a trend plot
+//|    with cairo: a reference to the cached static parts of the plot, the
+//|    layout of the graph, the ticks along the x axis and the decimated
+//|    line of each data set. It doesn't refer back to the plot or its data
+//|    sets, so once it has been built on the GUI thread it can be drawn on
+//|    any thread.
+//|
+//|    The lines and ticks are kept when the scene is rebuilt so that the
+//|    storage is reused from one frame to the next.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotScene
+{
+    public:
+        wxTrendPlotScene(void);
+
+        ~wxTrendPlotScene(void);
+
+        // Exchange the contents of two scenes without copying them
+        void Swap(wxTrendPlotScene& other);
+
+        // Start a new frame of the size specified, copying the static
+        // parts of the plot from chrome. The graph is the area the
+        // lines are drawn in.
+        void Begin(const wxRect&    rect,
+                   cairo_surface_t* chrome,
+                   const wxRect&    graph,
+                   bool             clip);
+
+        // Let go of the static parts of the plot
+        void ReleaseChrome(void);
+
+        // Add a tick along the x axis at the screen x specified
+        void AddTick(double x, double width, const std::string& text);
+
+        // Add the line of a data set, drawn in the colour specified
+        void AddLine(double red, double green, double blue, const std::vector<wxPoint>& points);
+
+        // Show that the plot is paused and how far it is zoomed. The
+        // zoom label is formatted by the caller and left empty when the
+        // plot isn't zoomed.
+        void SetStatus(bool paused, const std::string& zoom)
+        {
+            m_paused = paused;
+            m_zoom = zoom;
+        }
+
+        // The y co-ordinate of the baseline of the x axis labels
+        void SetLabelY(double label_y)
+        {
+            m_label_y = label_y;
+        }
+
+        const wxRect& GetRect(void) const
+        {
+            return m_rect;
+        }
+
+        const wxRect& GetGraph(void) const
+        {
+            return m_graph;
+        }
+
+        // Draw the whole frame
+        void Draw(cairo_t* cairo_image) const;
+
+        // Draw the frame in stages. The background is the static parts
+        // of the plot and the grid lines across the x axis and the
+        // foreground is the ticks and labels along the x axis.
+        void DrawBackground(cairo_t* cairo_image) const;
+        void DrawLines(cairo_t* cairo_image) const;
+        void DrawForeground(cairo_t* cairo_image) const;
+
+        // Draw the lines that fall inside a tile of columns of the
+        // frame, exactly as DrawLines() would draw them there. The
+        // tiles have to be followed by HideOverflow().
+        void DrawTile(cairo_t* cairo_tile, const wxRect& tile) const;
+
+        // Hide the parts of the lines that aren't clipped to the graph
+        void HideOverflow(cairo_t* cairo_image) const;
+
+        // Work out which sides of an area a point falls outside of,
+        // as a combination of the OUTCODE_ flags.
+        static int GetOutCode(const wxPoint& point, const wxRect& area);
+
+        // Whether the segment between points with the codes specified
+        // is left out, either because it is entirely outside of the
+        // area or because one end of it is a gap.
+        static bool IsHidden(int code, int last_code)
+        {
+            return ((code & last_code) != 0) || (((code | last_code) & OUTCODE_GAP) != 0);
+        }
+
+        // Stroke a line as a single path, leaving out the segments that
+        // are entirely outside of the visible area or cross a gap.
+        static void StrokeLine(cairo_t*                    cairo_image,
+                               const std::vector<wxPoint>& points,
+                               const wxRect&               visible);
+
+    private:
+        // Scenes hold a reference to the chrome so they are swapped
+        // rather than copied.
+        wxTrendPlotScene(const wxTrendPlotScene&);
+        wxTrendPlotScene& operator=(const wxTrendPlotScene&);
+
+        wxRect           m_rect;
+        cairo_surface_t* m_chrome;
+        wxRect           m_graph;
+        bool             m_clip;
+        double           m_label_y;
+        bool             m_paused;
+        std::string      m_zoom;
+
+        // Only the first count of each are part of the scene
+        std::vector<wxTrendPlotSceneTick> m_ticks;
+        size_t                            m_tick_count;
+        std::vector<wxTrendPlotSceneLine> m_lines;
+        size_t                            m_line_count;
+};
+
+#endif // __TREND_PLOT_SCENE_H__
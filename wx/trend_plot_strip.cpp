@@ -0,0 +1,405 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_strip.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the ring of pixel columns
+//|    used by the trend plot when it is drawn as a strip chart.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include "wx/trend_plot_strip.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotStrip()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the strip class. The ring isn't created
+//|    until the size of the graph is known.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotStrip::wxTrendPlotStrip(void)
+{
+    m_surface = NULL;
+    m_context = NULL;
+    m_width = 0;
+    m_height = 0;
+    m_x_increment = 0;
+
+    Invalidate();
+}
+
+
+wxTrendPlotStrip::~wxTrendPlotStrip(void)
+{
+    Destroy();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Setup()
+//|
+//| PARAMETERS:
+//|    target      (I) - The cairo context the plot is being drawn with.
+//|    width       (I) - The width of the graph in pixels.
+//|    height      (I) - The height of the graph in pixels.
+//|    x_increment (I) - The x units per pixel.
+//|
+//| FUNCTION:
+//|    This method is called before each frame to make sure the ring
+//|    matches the graph. The ring is created to be similar to the
+//|    surface being drawn on so that copying it is as cheap as possible.
+//|    It is re-created if the size of the graph changes and all the
+//|    columns are redrawn if the scale of the x axis changes.
+//|
+//| RETURNS:
+//|    false if the graph has no size, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotStrip::Setup(cairo_t* target,
+                             int      width,
+                             int      height,
+                             double   x_increment)
+{
+    if(m_surface != NULL && (width != m_width || height != m_height))
+    {
+        Destroy();
+    }
+
+    if(width <= 0 || height <= 0 || x_increment <= 0)
+    {
+        return false;
+    }
+
+    if(m_surface == NULL)
+    {
+        m_surface = cairo_surface_create_similar(cairo_get_target(target),
+                                                 CAIRO_CONTENT_COLOR_ALPHA,
+                                                 width,
+                                                 height);
+        m_context = cairo_create(m_surface);
+        m_width = width;
+        m_height = height;
+
+        Invalidate();
+    }
+
+    if(x_increment != m_x_increment)
+    {
+        m_x_increment = x_increment;
+
+        Invalidate();
+    }
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Destroy()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method releases the ring. It is re-created the next time the
+//|    plot is drawn.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotStrip::Destroy(void)
+{
+    if(m_context != NULL)
+    {
+        cairo_destroy(m_context);
+        m_context = NULL;
+    }
+
+    if(m_surface != NULL)
+    {
+        cairo_surface_destroy(m_surface);
+        m_surface = NULL;
+    }
+
+    m_width = 0;
+    m_height = 0;
+
+    Invalidate();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Invalidate()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is called when the whole graph needs to be redrawn,
+//|    for example when a data set is added or removed.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotStrip::Invalidate(void)
+{
+    m_valid = false;
+    m_first = 0;
+    m_end = 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    InvalidateFrom()
+//|
+//| PARAMETERS:
+//|    x (I) - The x value from which the graph has changed.
+//|
+//| FUNCTION:
+//|    This method is called when points are added to the plot. The
+//|    columns from the one containing x onwards are drawn again on
+//|    the next frame.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotStrip::InvalidateFrom(double x)
+{
+    if(!m_valid)
+    {
+        return;
+    }
+
+    wxInt64 column = GetColumn(x);
+
+    if(column < m_first)
+    {
+        Invalidate();
+    }
+    else if(column < m_end)
+    {
+        m_end = column;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    FindDirtyColumns()
+//|
+//| PARAMETERS:
+//|    start_column (I) - The column at the left hand side of the graph.
+//|    first        (O) - The first column to draw.
+//|    last         (O) - One past the last column to draw.
+//|
+//| FUNCTION:
+//|    This method works out which of the visible columns haven't been
+//|    drawn yet. If the plot has scrolled backwards everything is drawn
+//|    again.
+//|
+//| RETURNS:
+//|    false if there is nothing to draw, true otherwise.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotStrip::FindDirtyColumns(wxInt64  start_column,
+                                        wxInt64& first,
+                                        wxInt64& last)
+{
+    if(m_valid && start_column < m_first)
+    {
+        Invalidate();
+    }
+
+    first = start_column;
+    last = start_column + m_width;
+
+    if(m_valid && m_end > first)
+    {
+        first = m_end;
+    }
+
+    return first < last;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Begin()
+//|
+//| PARAMETERS:
+//|    first (I) - The first column to draw.
+//|    last  (I) - One past the last column to draw.
+//|
+//| FUNCTION:
+//|    This method is called before drawing a run of columns. The columns
+//|    are cleared and the context is clipped to them so that the parts
+//|    of the lines that belong to other columns are left alone.
+//|
+//| RETURNS:
+//|    The cairo context to draw with.
+//|
+//+------------------------------------------------------------------------------
+cairo_t* wxTrendPlotStrip::Begin(wxInt64 first, wxInt64 last)
+{
+    cairo_save(m_context);
+
+    cairo_rectangle(m_context,
+                    GetOffset(first),
+                    0,
+                    last - first,
+                    m_height);
+    cairo_clip(m_context);
+
+    cairo_set_operator(m_context, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(m_context);
+    cairo_set_operator(m_context, CAIRO_OPERATOR_OVER);
+
+    return m_context;
+}
+
+
+void wxTrendPlotStrip::End(void)
+{
+    cairo_restore(m_context);
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Validate()
+//|
+//| PARAMETERS:
+//|    first (I) - The first column that was drawn.
+//|    last  (I) - One past the last column that was drawn.
+//|
+//| FUNCTION:
+//|    This method records the columns that have been drawn. The ring
+//|    only holds one graph width of columns so anything older than
+//|    that has been drawn over.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotStrip::Validate(wxInt64 first, wxInt64 last)
+{
+    if(!m_valid || first > m_end)
+    {
+        m_first = first;
+    }
+
+    m_end = last;
+
+    if(m_end - m_first > m_width)
+    {
+        m_first = m_end - m_width;
+    }
+
+    m_valid = true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Draw()
+//|
+//| PARAMETERS:
+//|    cairo_image  (I) - The cairo context to draw on.
+//|    x            (I) - The left hand side of the graph.
+//|    y            (I) - The top of the graph.
+//|    start_column (I) - The column at the left hand side of the graph.
+//|
+//| FUNCTION:
+//|    This method copies the ring onto the graph. The columns from
+//|    start_column to the end of the ring are copied first followed by
+//|    the columns that have wrapped around to the start of it.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotStrip::Draw(cairo_t* cairo_image,
+                            int      x,
+                            int      y,
+                            wxInt64  start_column) const
+{
+    if(m_surface == NULL)
+    {
+        return;
+    }
+
+    int offset = GetOffset(start_column);
+    int split = m_width - offset;
+
+    cairo_save(cairo_image);
+
+    cairo_set_source_surface(cairo_image, m_surface, x - offset, y);
+    cairo_rectangle(cairo_image, x, y, split, m_height);
+    cairo_fill(cairo_image);
+
+    if(offset != 0)
+    {
+        cairo_set_source_surface(cairo_image, m_surface, x + split, y);
+        cairo_rectangle(cairo_image, x + split, y, offset, m_height);
+        cairo_fill(cairo_image);
+    }
+
+    cairo_restore(cairo_image);
+}
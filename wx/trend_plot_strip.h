@@ -0,0 +1,121 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_strip.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the ring of pixel columns used
+//|    by the trend plot when it is drawn as a strip chart.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_STRIP_H__
+#define __TREND_PLOT_STRIP_H__
+
+#include <cmath>
+#include <cairo.h>
+#include <wx/defs.h>
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotStrip
+//|
+//| DESCRIPTION:
+//|    This class holds an off-screen image of the graph area of a trend
+//|    plot that is used as a ring of pixel columns. Each column of the
+//|    ring shows a fixed slice of the x axis, so as the plot scrolls
+//|    only the columns that have just come into view have to be drawn.
+//|    The ring is copied onto the screen in two pieces either side of
+//|    the point where it wraps around.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotStrip
+{
+    public:
+        wxTrendPlotStrip(void);
+
+        ~wxTrendPlotStrip(void);
+
+        // Make sure the ring matches the size and scale of the graph.
+        // The columns drawn so far are forgotten if anything changed.
+        bool Setup(cairo_t* target,
+                   int      width,
+                   int      height,
+                   double   x_increment);
+
+        // Release the ring
+        void Destroy(void);
+
+        // Forget all the columns drawn so far
+        void Invalidate(void);
+
+        // Forget the columns from the one containing x onwards
+        void InvalidateFrom(double x);
+
+        // Get the column containing the x value specified. Columns
+        // are counted from x = 0, so they need 64 bits to cover x
+        // values such as times since the epoch.
+        wxInt64 GetColumn(double x) const
+        {
+            return (wxInt64)floor(x / m_x_increment);
+        }
+
+        // Get the position of a column within the ring
+        int GetOffset(wxInt64 column) const
+        {
+            wxInt64 offset = column % m_width;
+
+            if(offset < 0)
+            {
+                offset += m_width;
+            }
+
+            return (int)offset;
+        }
+
+        int GetWidth(void) const
+        {
+            return m_width;
+        }
+
+        int GetHeight(void) const
+        {
+            return m_height;
+        }
+
+        // Find the columns that need to be drawn to show the graph
+        // starting at start_column.
+        bool FindDirtyColumns(wxInt64  start_column,
+                              wxInt64& first,
+                              wxInt64& last);
+
+        // Start drawing the columns [first, last), which must not wrap
+        // around the end of the ring. The context returned is clipped
+        // to the columns, which have been cleared.
+        cairo_t* Begin(wxInt64 first, wxInt64 last);
+        void End(void);
+
+        // Record that the columns [first, last) have been drawn
+        void Validate(wxInt64 first, wxInt64 last);
+
+        // Copy the ring onto the graph with start_column at x
+        void Draw(cairo_t* cairo_image, int x, int y, wxInt64 start_column) const;
+
+    private:
+        cairo_surface_t* m_surface;
+        cairo_t*         m_context;
+
+        int    m_width;
+        int    m_height;
+        double m_x_increment;
+
+        // The columns [m_first, m_end) are up to date
+        bool m_valid;
+        wxInt64 m_first;
+        wxInt64 m_end;
+};
+
+#endif // __TREND_PLOT_STRIP_H__
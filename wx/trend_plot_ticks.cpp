@@ -0,0 +1,215 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_ticks.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the class used to place the
+//|    ticks along an axis of a trend plot.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <cmath>
+
+#include "wx/trend_plot_ticks.h"
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotTicks()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the ticks class. There are no ticks
+//|    until the first update.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotTicks::wxTrendPlotTicks(void)
+{
+    m_step = 0;
+    m_decimals = 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Update()
+//|
+//| PARAMETERS:
+//|    min     (I) - The value at the start of the axis.
+//|    max     (I) - The value at the end of the axis.
+//|    length  (I) - The length of the axis in pixels.
+//|    spacing (I) - The fewest pixels between ticks.
+//|
+//| FUNCTION:
+//|    This method picks the smallest nice step that keeps the ticks
+//|    spacing pixels apart and places a tick at each multiple of it
+//|    inside the range. The labels are thrown away if the step changes
+//|    since they may need a different number of decimal places.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotTicks::Update(double min, double max, int length, int spacing)
+{
+    m_values.clear();
+
+    double range = max - min;
+
+    // An empty or infinite range can't be divided up
+    if(!(range > 0) || range * 0 != 0 || length <= 0 || spacing <= 0)
+    {
+        return;
+    }
+
+    int count = length / spacing;
+
+    if(count < 1)
+    {
+        count = 1;
+    }
+
+    // Round the step up to 1, 2 or 5 times a power of ten
+    double raw = range / count;
+    int    exponent = (int)floor(log10(raw));
+    double power = pow(10.0, exponent);
+    double fraction = raw / power;
+    double nice;
+
+    if(fraction <= 1)
+    {
+        nice = 1;
+    }
+    else if(fraction <= 2)
+    {
+        nice = 2;
+    }
+    else if(fraction <= 5)
+    {
+        nice = 5;
+    }
+    else
+    {
+        nice = 1;
+        exponent++;
+        power *= 10;
+    }
+
+    double step = nice * power;
+
+    if(step != m_step)
+    {
+        m_step = step;
+        m_decimals = (exponent < 0) ? -exponent : 0;
+        m_labels.clear();
+    }
+
+    // Work each value out from its multiple of the step so that
+    // the same tick always has exactly the same value. There can't
+    // be more than count + 1 of them.
+    double first = ceil(min / step);
+
+    for(int index = 0; index <= count; index++)
+    {
+        double value = (first + index) * step;
+
+        if(value > max)
+        {
+            break;
+        }
+
+        // Don't label a tick as -0
+        if(value == 0)
+        {
+            value = 0;
+        }
+
+        m_values.push_back(value);
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    GetLabel()
+//|
+//| PARAMETERS:
+//|    value (I) - The value of the tick.
+//|    font  (I) - Identifies the font the label is drawn in.
+//|
+//| FUNCTION:
+//|    This method finds the label of a tick, formatting it the first
+//|    time it is asked for. The labels are all thrown away if too many
+//|    build up from scrolling a long way.
+//|
+//| RETURNS:
+//|    The label, which stays valid until the next call.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotTickLabel& wxTrendPlotTicks::GetLabel(double value, int font)
+{
+    std::pair<double, int> key(value, font);
+
+    std::map<std::pair<double, int>, wxTrendPlotTickLabel>::iterator iter;
+
+    iter = m_labels.find(key);
+
+    if(iter != m_labels.end())
+    {
+        return iter->second;
+    }
+
+    if(m_labels.size() >= TREND_PLOT_TICK_LABELS)
+    {
+        m_labels.clear();
+    }
+
+    wxTrendPlotTickLabel& label = m_labels[key];
+    label.label = wxString::Format(wxT("%.*f"), m_decimals, value);
+    label.text = label.label.mb_str();
+    label.measured = false;
+    label.width = 0;
+    label.height = 0;
+
+    return label;
+}
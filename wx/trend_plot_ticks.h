@@ -0,0 +1,103 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_ticks.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the class used to place the
+//|    ticks along an axis of a trend plot.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_TICKS_H__
+#define __TREND_PLOT_TICKS_H__
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <wx/defs.h>
+#include <wx/string.h>
+
+// The most labels kept before they are all thrown away
+#define TREND_PLOT_TICK_LABELS 256
+
+
+//+------------------------------------------------------------------------------
+//|
+//| STRUCTURE:
+//|    wxTrendPlotTickLabel
+//|
+//| DESCRIPTION:
+//|    This structure holds the label of a tick, formatted once, and its
+//|    size once it has been measured in the font it is drawn with.
+//|
+//+------------------------------------------------------------------------------
+struct wxTrendPlotTickLabel
+{
+    std::string text;
+    wxString    label;
+
+    bool   measured;
+    double width;
+    double height;
+};
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotTicks
+//|
+//| DESCRIPTION:
+//|    This class places the ticks along an axis at a "nice" step of 1, 2
+//|    or 5 times a power of ten, picked so that the ticks are no closer
+//|    together on screen than a given spacing. The ticks sit on whole
+//|    multiples of the step, so as the plot scrolls the ticks that stay
+//|    on screen keep their values.
+//|
+//|    The labels are formatted with as many decimal places as the step
+//|    needs and kept along with their size, keyed by the value and the
+//|    font, so a label is only formatted and measured once for as long
+//|    as the step doesn't change.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotTicks
+{
+    public:
+        wxTrendPlotTicks(void);
+
+        // Place the ticks for the range [min, max] drawn across length
+        // pixels, at least spacing pixels apart.
+        void Update(double min, double max, int length, int spacing);
+
+        size_t GetCount(void) const
+        {
+            return m_values.size();
+        }
+
+        double GetValue(size_t index) const
+        {
+            return m_values[index];
+        }
+
+        double GetStep(void) const
+        {
+            return m_step;
+        }
+
+        // Find the label of a tick for a font, formatting it if it
+        // hasn't been already. It still has to be measured if it
+        // hasn't been measured in that font.
+        wxTrendPlotTickLabel& GetLabel(double value, int font);
+
+    private:
+        double              m_step;
+        int                 m_decimals;
+        std::vector<double> m_values;
+
+        std::map<std::pair<double, int>, wxTrendPlotTickLabel> m_labels;
+};
+
+#endif // __TREND_PLOT_TICKS_H__
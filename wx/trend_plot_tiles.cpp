@@ -0,0 +1,513 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_tiles.cpp
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the implementation of the pool of threads used to
+//|    draw the lines of a trend plot in vertical tiles.
+//|
+//+------------------------------------------------------------------------------
+//|
+//| Copyright (c) 2008 Brad Elliott
+//|
+//|  This example is free software; you can redistribute it and/or modify it
+//|  under the terms of the GNU Library General Public Licence as published by
+//|  the Free Software Foundation; either version 2 of the Licence, or (at
+//|  your option) any later version.
+//|
+//|  This library is distributed in the hope that it will be useful, but
+//|  WITHOUT ANY WARRANTY; without even the implied warranty of
+//|  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library
+//|  General Public Licence for more details.
+//|
+//|  You should have received a copy of the GNU Library General Public Licence
+//|  along with this software, usually in a file named COPYING.LIB.  If not,
+//|  write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+//|  Boston, MA 02111-1307 USA.
+//|
+//+------------------------------------------------------------------------------
+
+// For compilers that support precompilation, includes "wx/wx.h".
+#include "wx/wxprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+// for all others, include the necessary headers (this file is usually all you
+// need because it includes almost all "standard" wxWidgets headers)
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <algorithm>
+
+#include "wx/trend_plot_tiles.h"
+
+
+wxTrendPlotTileWorker::wxTrendPlotTileWorker(wxTrendPlotTilePool* pool)
+        : wxThread(wxTHREAD_JOINABLE)
+{
+    m_pool = pool;
+}
+
+
+wxThread::ExitCode wxTrendPlotTileWorker::Entry(void)
+{
+    m_pool->Work();
+
+    return 0;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    wxTrendPlotTilePool()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| DESCRIPTION:
+//|    This is the constructor for the tile pool class. There are no
+//|    worker threads until SetThreadCount() is called.
+//|
+//+------------------------------------------------------------------------------
+wxTrendPlotTilePool::wxTrendPlotTilePool(void)
+        : m_start(m_mutex),
+          m_done(m_mutex),
+          m_next(0)
+{
+    m_stop = false;
+    m_frame = 0;
+    m_busy = 0;
+    m_remaining = 0;
+
+    m_scene = NULL;
+    m_data = NULL;
+    m_format = CAIRO_FORMAT_RGB24;
+    m_stride = 0;
+    m_height = 0;
+
+    m_operator = CAIRO_OPERATOR_OVER;
+    m_antialias = CAIRO_ANTIALIAS_DEFAULT;
+    m_tolerance = 0.1;
+    m_line_join = CAIRO_LINE_JOIN_MITER;
+    m_line_cap = CAIRO_LINE_CAP_BUTT;
+    m_miter_limit = 10;
+}
+
+
+wxTrendPlotTilePool::~wxTrendPlotTilePool(void)
+{
+    Stop();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    SetThreadCount()
+//|
+//| PARAMETERS:
+//|    count (I) - The number of worker threads.
+//|
+//| FUNCTION:
+//|    This method replaces the worker threads with the number specified.
+//|    If any of them can't be started then they are all stopped again,
+//|    leaving the tiles turned off. It waits for any frame being drawn
+//|    to be finished first.
+//|
+//| RETURNS:
+//|    false if the threads couldn't be started.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotTilePool::SetThreadCount(int count)
+{
+    wxMutexLocker draw_lock(m_draw_mutex);
+
+    Stop();
+
+    if(count <= 0)
+    {
+        return true;
+    }
+
+    if(!m_start.IsOk() || !m_done.IsOk())
+    {
+        return false;
+    }
+
+    for(int thread = 0; thread < count; thread++)
+    {
+        wxTrendPlotTileWorker* worker = new wxTrendPlotTileWorker(this);
+
+        if(worker->Create() != wxTHREAD_NO_ERROR ||
+           worker->Run() != wxTHREAD_NO_ERROR)
+        {
+            delete worker;
+            Stop();
+
+            return false;
+        }
+
+        m_threads.push_back(worker);
+    }
+
+    return true;
+}
+
+
+int wxTrendPlotTilePool::GetThreadCount(void)
+{
+    wxMutexLocker draw_lock(m_draw_mutex);
+
+    return (int)m_threads.size();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Stop()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method asks the worker threads to finish, waits for them and
+//|    deletes them. It must be called with the draw lock held so that
+//|    no frame is being drawn.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotTilePool::Stop(void)
+{
+    if(m_threads.empty())
+    {
+        return;
+    }
+
+    {
+        wxMutexLocker lock(m_mutex);
+
+        m_stop = true;
+        m_start.Broadcast();
+    }
+
+    for(size_t thread = 0; thread < m_threads.size(); thread++)
+    {
+        m_threads[thread]->Wait();
+        delete m_threads[thread];
+    }
+    m_threads.clear();
+
+    wxMutexLocker lock(m_mutex);
+
+    m_stop = false;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrawLines()
+//|
+//| PARAMETERS:
+//|    scene       (I) - The scene whose lines are drawn.
+//|    cairo_image (I) - The cairo context to draw with.
+//|
+//| FUNCTION:
+//|    This method splits the graph of the scene into one tile for each
+//|    thread, as long as the tiles are wide enough, and draws the tiles
+//|    on the worker threads and this one. It then hides the parts of the
+//|    lines outside of the graph, if they aren't clipped to it, so the
+//|    frame is left as wxTrendPlotScene::DrawLines() would leave it.
+//|
+//|    The tiles are drawn straight into the pixels of the surface the
+//|    context draws on, so the surface must be an image surface with 32
+//|    bits per pixel and the context mustn't transform what it draws.
+//|    Nothing is drawn otherwise.
+//|
+//| RETURNS:
+//|    true if the lines were drawn.
+//|
+//+------------------------------------------------------------------------------
+bool wxTrendPlotTilePool::DrawLines(const wxTrendPlotScene& scene,
+                                    cairo_t*                cairo_image)
+{
+    wxMutexLocker draw_lock(m_draw_mutex);
+
+    if(m_threads.empty())
+    {
+        return false;
+    }
+
+    cairo_surface_t* frame = cairo_get_target(cairo_image);
+
+    if(cairo_surface_get_type(frame) != CAIRO_SURFACE_TYPE_IMAGE)
+    {
+        return false;
+    }
+
+    cairo_format_t format = cairo_image_surface_get_format(frame);
+
+    if(format != CAIRO_FORMAT_ARGB32 && format != CAIRO_FORMAT_RGB24)
+    {
+        return false;
+    }
+
+    // The tiles are placed in the frame by whole pixels, which only
+    // draws them where the context would if it maps the plot straight
+    // onto the frame.
+    cairo_matrix_t matrix;
+    double offset_x;
+    double offset_y;
+
+    cairo_get_matrix(cairo_image, &matrix);
+    cairo_surface_get_device_offset(frame, &offset_x, &offset_y);
+
+    if(matrix.xx != 1 || matrix.yx != 0 ||
+       matrix.xy != 0 || matrix.yy != 1 ||
+       matrix.x0 != 0 || matrix.y0 != 0 ||
+       offset_x != 0 || offset_y != 0)
+    {
+        return false;
+    }
+
+    // Split the part of the graph inside the frame into tiles
+    const wxRect& graph = scene.GetGraph();
+    int width = cairo_image_surface_get_width(frame);
+    int left = std::max(graph.x, 0);
+    int right = std::min(graph.x + graph.width, width);
+    int count = std::min((int)m_threads.size() + 1,
+                         (right - left) / TREND_PLOT_MIN_TILE_WIDTH);
+
+    if(count < 2)
+    {
+        return false;
+    }
+
+    // Finish anything drawn with the context before the tiles
+    // write to the pixels.
+    cairo_surface_flush(frame);
+
+    {
+        wxMutexLocker lock(m_mutex);
+
+        // Wait for any worker that woke up too late for the last
+        // frame to give up on it.
+        while(m_busy > 0)
+        {
+            m_done.Wait();
+        }
+
+        m_scene = &scene;
+        m_data = cairo_image_surface_get_data(frame);
+        m_format = format;
+        m_stride = cairo_image_surface_get_stride(frame);
+        m_height = cairo_image_surface_get_height(frame);
+
+        m_operator = cairo_get_operator(cairo_image);
+        m_antialias = cairo_get_antialias(cairo_image);
+        m_tolerance = cairo_get_tolerance(cairo_image);
+        m_line_join = cairo_get_line_join(cairo_image);
+        m_line_cap = cairo_get_line_cap(cairo_image);
+        m_miter_limit = cairo_get_miter_limit(cairo_image);
+
+        m_tiles.resize(count);
+
+        for(int tile = 0; tile < count; tile++)
+        {
+            int tile_left = left + (((right - left) * tile) / count);
+            int tile_right = left + (((right - left) * (tile + 1)) / count);
+
+            m_tiles[tile] = wxRect(tile_left, 0, tile_right - tile_left, m_height);
+        }
+
+        m_next = 0;
+        m_remaining = count;
+        m_frame++;
+        m_start.Broadcast();
+    }
+
+    DrawTiles();
+
+    {
+        wxMutexLocker lock(m_mutex);
+
+        while(m_remaining > 0)
+        {
+            m_done.Wait();
+        }
+
+        m_scene = NULL;
+        m_data = NULL;
+    }
+
+    // Let cairo know the pixels have changed under it
+    cairo_surface_mark_dirty(frame);
+
+    scene.HideOverflow(cairo_image);
+
+    return true;
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    Work()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method is run by each worker thread. It waits for a frame to
+//|    be posted, helps draw its tiles and goes back to waiting, until
+//|    the pool is stopped.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotTilePool::Work(void)
+{
+    m_mutex.Lock();
+
+    wxUint32 frame = m_frame;
+
+    for(;;)
+    {
+        while(!m_stop && m_frame == frame)
+        {
+            m_start.Wait();
+        }
+
+        if(m_stop)
+        {
+            break;
+        }
+
+        frame = m_frame;
+        m_busy++;
+
+        m_mutex.Unlock();
+        DrawTiles();
+        m_mutex.Lock();
+
+        m_busy--;
+
+        if(m_busy == 0)
+        {
+            m_done.Signal();
+        }
+    }
+
+    m_mutex.Unlock();
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrawTiles()
+//|
+//| PARAMETERS:
+//|    None.
+//|
+//| FUNCTION:
+//|    This method claims the tiles of the current frame one at a time and
+//|    draws them until they have all been claimed. Whoever finishes the
+//|    last tile wakes up the thread waiting for the frame.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotTilePool::DrawTiles(void)
+{
+    size_t tile = 0;
+    bool   drawn = false;
+
+    for(;;)
+    {
+        {
+            wxMutexLocker lock(m_mutex);
+
+            // Hand in the last tile and claim the next one in
+            // the same go, since there are only a few of them.
+            if(drawn)
+            {
+                m_remaining--;
+
+                if(m_remaining == 0)
+                {
+                    m_done.Signal();
+                }
+            }
+
+            if(m_next >= m_tiles.size())
+            {
+                break;
+            }
+
+            tile = m_next++;
+        }
+
+        DrawTile(m_tiles[tile]);
+        drawn = true;
+    }
+}
+
+
+//+------------------------------------------------------------------------------
+//|
+//| NAME:
+//|    DrawTile()
+//|
+//| PARAMETERS:
+//|    tile (I) - The columns of the frame covered by the tile.
+//|
+//| FUNCTION:
+//|    This method wraps the columns of the frame covered by a tile in an
+//|    image surface of their own and draws the lines of the scene into
+//|    it. The context is set up like the one drawing the frame and moved
+//|    so that the tile is drawn in its place in the frame.
+//|
+//| RETURNS:
+//|    None.
+//|
+//+------------------------------------------------------------------------------
+void wxTrendPlotTilePool::DrawTile(const wxRect& tile)
+{
+    // Both formats use 4 bytes per pixel
+    cairo_surface_t* surface = cairo_image_surface_create_for_data(
+                                         m_data + (tile.x * 4),
+                                         m_format,
+                                         tile.width,
+                                         tile.height,
+                                         m_stride);
+
+    cairo_t* cairo_tile = cairo_create(surface);
+
+    cairo_set_operator(cairo_tile, m_operator);
+    cairo_set_antialias(cairo_tile, m_antialias);
+    cairo_set_tolerance(cairo_tile, m_tolerance);
+    cairo_set_line_join(cairo_tile, m_line_join);
+    cairo_set_line_cap(cairo_tile, m_line_cap);
+    cairo_set_miter_limit(cairo_tile, m_miter_limit);
+
+    cairo_translate(cairo_tile, -tile.x, 0);
+
+    m_scene->DrawTile(cairo_tile, tile);
+
+    cairo_destroy(cairo_tile);
+    cairo_surface_flush(surface);
+    cairo_surface_destroy(surface);
+}
@@ -0,0 +1,144 @@
+//+------------------------------------------------------------------------------
+//|
+//| FILENAME: trend_plot_tiles.h
+//|
+//| PROJECT:
+//|    wxWidgets Cairo utilities.
+//|
+//| FILE DESCRIPTION:
+//|    This file contains the definition of the pool of threads used to
+//|    draw the lines of a trend plot in vertical tiles.
+//|
+//+------------------------------------------------------------------------------
+#ifndef __TREND_PLOT_TILES_H__
+#define __TREND_PLOT_TILES_H__
+
+#include <vector>
+#include <cairo.h>
+#include <wx/thread.h>
+
+#include "wx/trend_plot_scene.h"
+
+// Tiles are never made narrower than this many pixels, since below it
+// the cost of each tile outweighs sharing out the work.
+#define TREND_PLOT_MIN_TILE_WIDTH 64
+
+class wxTrendPlotTilePool;
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotTileWorker
+//|
+//| DESCRIPTION:
+//|    This class is one of the threads of a tile pool. It just runs the
+//|    work loop of the pool until the pool is stopped.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotTileWorker : public wxThread
+{
+    public:
+        wxTrendPlotTileWorker(wxTrendPlotTilePool* pool);
+
+    protected:
+        virtual ExitCode Entry(void);
+
+    private:
+        wxTrendPlotTilePool* m_pool;
+};
+
+
+//+------------------------------------------------------------------------------
+//|
+//| CLASS:
+//|    wxTrendPlotTilePool
+//|
+//| DESCRIPTION:
+//|    This class draws the lines of a trend plot scene in parallel. The
+//|    graph is split into vertical tiles of whole pixels and each tile is
+//|    drawn through its own cairo image surface, which shares the pixels
+//|    of its columns of the frame. The tiles are handed out to the worker
+//|    threads and the thread drawing the frame, which all read the same
+//|    scene, so the tiles are in place in the frame as soon as the last
+//|    one is finished.
+//|
+//|    Every pixel ends up exactly as it would if the lines were drawn on
+//|    one thread. The tiles don't overlap, each tile only clips the lines
+//|    on a pixel boundary and the lines are drawn over the frame in the
+//|    same order as they would be otherwise.
+//|
+//+------------------------------------------------------------------------------
+class wxTrendPlotTilePool
+{
+    public:
+        wxTrendPlotTilePool(void);
+
+        ~wxTrendPlotTilePool(void);
+
+        // Start this many worker threads, as well as the thread that
+        // draws the frame. 0 stops them all, which turns the tiles off.
+        // Returns false if not all of them could be started.
+        bool SetThreadCount(int count);
+
+        int GetThreadCount(void);
+
+        // Draw the lines of a scene like wxTrendPlotScene::DrawLines().
+        // Returns false without drawing anything if the tiles are turned
+        // off, the graph is too narrow to split or the context doesn't
+        // draw straight into an image surface.
+        bool DrawLines(const wxTrendPlotScene& scene, cairo_t* cairo_image);
+
+    private:
+        friend class wxTrendPlotTileWorker;
+
+        // Stop and delete the worker threads
+        void Stop(void);
+
+        // The loop run by each worker thread
+        void Work(void);
+
+        // Take tiles and draw them until there are none left
+        void DrawTiles(void);
+        void DrawTile(const wxRect& tile);
+
+        // Held for the whole of DrawLines() so that the threads
+        // can't be changed while a frame is being drawn.
+        wxMutex m_draw_mutex;
+
+        std::vector<wxTrendPlotTileWorker*> m_threads;
+
+        // Guards the state shared with the workers. The workers are
+        // woken by m_start when a new frame is posted and the thread
+        // drawing the frame is woken by m_done.
+        wxMutex     m_mutex;
+        wxCondition m_start;
+        wxCondition m_done;
+        bool        m_stop;
+        wxUint32    m_frame;
+
+        // The number of workers looking at the frame and the number
+        // of its tiles not yet finished. The frame isn't changed
+        // until both are 0.
+        int    m_busy;
+        size_t m_remaining;
+
+        // The frame being drawn and the next of its tiles to claim
+        const wxTrendPlotScene* m_scene;
+        unsigned char*          m_data;
+        cairo_format_t          m_format;
+        int                     m_stride;
+        int                     m_height;
+        std::vector<wxRect>     m_tiles;
+        size_t                  m_next;
+
+        // How the lines are drawn in the frame, copied to each tile
+        cairo_operator_t  m_operator;
+        cairo_antialias_t m_antialias;
+        double            m_tolerance;
+        cairo_line_join_t m_line_join;
+        cairo_line_cap_t  m_line_cap;
+        double            m_miter_limit;
+};
+
+#endif // __TREND_PLOT_TILES_H__
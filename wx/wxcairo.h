@@ -8,6 +8,9 @@
 #define RENDER_CAIRO_NATIVE 1
 #define RENDER_NATIVE       2
 
+// Only supported by the trend plot
+#define RENDER_CAIRO_THREAD 3
+
 
 #endif // __WXCAIRO_H__
 
@@ -180,6 +180,13 @@ wxCairoClock::~wxCairoClock(void)
 void wxCairoClock::SetRenderer(int renderer)
 {
     m_renderer = renderer;
+    
+    // Release the off-screen buffer when it isn't being used
+    if(m_renderer != RENDER_CAIRO_BUFFER)
+    {
+        m_buffer.Resize(0, 0);
+    }
+    
     Refresh(false);
 }
 
@@ -906,57 +913,20 @@ void wxCairoClock::OnPaint(wxPaintEvent &WXUNUSED(event))
             
             break;
         }
-        // In this case it would make an awful lot of sense to perform
-        // the malloc calls and the creation of the cairo surface in
-        // the onsize method. This would prevent the overhead of all
-        // this allocation on every paint call. We could also move the
-        // wxImage constructor there as well.
+        // The buffer, cairo surface and bitmap are kept between
+        // paints and only re-allocated when the size changes so
+        // painting doesn't allocate any memory.
         case RENDER_CAIRO_BUFFER:
         {
-            unsigned char* image_buffer = (unsigned char*)malloc(rect.width * rect.height * 4);
-            unsigned int image_buffer_len = rect.width * rect.height * 4;
-            
-            cairo_surface_t* cairo_surface = cairo_image_surface_create_for_data(
-                                            image_buffer,
-                                            CAIRO_FORMAT_RGB24,
-                                            rect.width,
-                                            rect.height,
-                                            rect.width * 4);
-            cairo_t* cairo_image = cairo_create(cairo_surface);
+            m_buffer.Resize(rect.width, rect.height);
             
-            Render(true, cairo_image, rect.width, rect.height);
+            cairo_t* cairo_image = m_buffer.Begin();
             
-            // Now translate the raw image data from the format stored
-            // by cairo into a format understood by wxImage.
-            unsigned char* output = (unsigned char*)malloc(image_buffer_len);
-            int offset = 0;
-            for(size_t count = 0; count < image_buffer_len; count+=4)
+            if(cairo_image != NULL)
             {
-                int r = *(image_buffer+count+2);
-                *(output + offset) = r;
-                offset++;
-                int g = *(image_buffer+count+1);
-                *(output + offset) = g;
-                offset++;
-                int b = *(image_buffer+count+0);
-                *(output + offset) = b;
-                offset++;
-            } 
-            
-            
-            wxImage img(rect.width, rect.height, output, true);
-            wxBitmap bmp(img);
-            wxClientDC client_dc(this);
-            
-            // Create a double buffer to draw the plot
-            // on screen to prevent flicker from occuring.
-            wxBufferedDC dc;
-            dc.Init(&client_dc, bmp);
-            
-            cairo_destroy(cairo_image);
-            cairo_surface_destroy(cairo_surface);
-            free(image_buffer);
-            free(output);
+                Render(true, cairo_image, rect.width, rect.height);
+                m_buffer.End(dc);
+            }
             break;
         }
         
@@ -1021,6 +991,11 @@ void wxCairoClock::OnSize(wxSizeEvent& event)
 {
     wxRect rect = GetClientRect();
     
+    if(m_renderer == RENDER_CAIRO_BUFFER)
+    {
+        m_buffer.Resize(rect.width, rect.height);
+    }
+    
     Refresh(false);
     event.Skip();
 }
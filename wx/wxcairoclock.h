@@ -67,6 +67,7 @@
 #include <wx/dcbuffer.h>
 
 #include "wx/wxcairo.h"
+#include "wx/cairo_buffer.h"
 
 
 //+------------------------------------------------------------------------------
@@ -146,6 +147,9 @@ class wxCairoClock: public wxPanel
         double m_minute_angle;
         double m_second_angle;
         
+        // The off-screen buffer used by RENDER_CAIRO_BUFFER
+        wxCairoBuffer m_buffer;
+        
 };
 
 